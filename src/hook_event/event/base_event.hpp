@@ -1,50 +1,90 @@
 #pragma once
 
 #include <boost/asio.hpp>
-#include <boost/signals2.hpp>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <opencv2/opencv.hpp>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "../utils/thread_affinity.hpp"
+#include "./event_clock.hpp"
+#include "./event_lanes.hpp"
+#include "./event_message.hpp"
+#include "./event_queue.hpp"
+#include "./event_type.hpp"
+#include "./events.hpp"
+#include "./frame_pool.hpp"
+#include "./pipeline_metrics.hpp"
+#include "./ring_dispatcher.hpp"
+
 using namespace boost;
 
 namespace hook_event::event {
 
-// 定义事件类型
-enum EnumEventType {
-  MatchStart = 0,         /// 比赛开始
-  MatchEnd,               /// 比赛结束
-  CameraStream,           /// 摄像头数据流
-  BallPosition,           /// 球位置
-  PredTrackBallPosition,  /// 预测球轨迹
-  RealTrackBallPosition,  /// 实际球轨迹
-  ShuttlecockPosition,    /// 击球点位置
+// 事件分发后端
+enum class EventBackend {
+  Asio = 0,  /// asio::io_context
+  LockFree,  /// 预分配无锁环形队列，直接调用回调
 };
 
-class EventMessage {
- public:
-  virtual void matchStartCallback() {};
-  virtual void matchEndCallback() {};
-  virtual void cameraStreamCallback(
-      const cv::Mat &leftFrame, const cv::Mat &rightFrame) {};
-  virtual void ballPositionCallback(
-      const cv::Point2f &leftPos, const cv::Point2f &rightPos) {};
-  // virtual void predTrackBallPositionCallback(const
-  // std::vector<cv::Point3f> &pos) {}; virtual void
-  // realTrackBallPositionCallback(const
-  // std::vector<cv::Point3f> &pos) {}; virtual void
-  // shuttlecockPositionCallback(const cv::Point3f &pos) {};
+struct EventManagerConfig {
+  // 事件队列容量及溢出策略，默认不限制
+  EventQueueConfig queue;
+  EventBackend backend = EventBackend::Asio;
+  // LockFree 后端的环形队列槽位数
+  size_t ringCapacity = 4096;
+  // 每个轨迹缓冲区（及 LockFree 后端每个槽位）预留的轨迹点数，
+  // 不超过时轨迹事件不产生内存分配
+  size_t ringReservePoints = 64;
+  // 轨迹缓冲区池中保留的空闲缓冲区数
+  size_t trackPoolSize = 64;
+  // 预分配的图像帧池，见 acquireFrame
+  FramePoolConfig framePool;
+  // Asio 后端的事件线程数。为 1 时所有回调串行执行；大于 1 时图像事件与遥测事件
+  // 各在一个 strand 上按顺序执行，两者可并行，比赛开始/结束与两类事件均保持先后顺序。
+  // 大于 1 时事件只在事件线程中分发，poll 不分发事件。LockFree 后端固定为单线程
+  size_t threads = 1;
+  // 事件线程绑定的 CPU，第 i 个线程绑定 cpus[i % cpus.size()]，空表示不绑定
+  std::vector<int> cpus;
+  // Asio 单线程时按 控制 > 遥测 > 图像 的优先级分发（见 EventLanes），
+  // 图像等待时遥测最多连续分发的事件数
+  size_t laneStarvationLimit = 16;
+  // 非空时记录各事件在队列中的等待时间
+  std::shared_ptr<PipelineMetrics> metrics;
 };
 
 // 事件管理器
 class EventManager {
  public:
-  EventManager()
+  EventManager(const EventManagerConfig &config = EventManagerConfig())
       : io_context_(),
         work_guard_(boost::asio::make_work_guard(io_context_)),
-        running_(false) {}
+        running_(false),
+        queue_(config.queue),
+        track_pool_(config.trackPoolSize),
+        frame_pool_(config.framePool),
+        reserve_points_(config.ringReservePoints),
+        metrics_(config.metrics),
+        threads_count_(config.threads ? config.threads : 1),
+        cpus_(config.cpus),
+        lanes_(config.laneStarvationLimit) {
+    if (config.backend == EventBackend::LockFree) {
+      ring_.reset(new RingDispatcher(
+          config.queue,
+          config.ringCapacity,
+          config.ringReservePoints,
+          callbacks_,
+          metrics_.get()));
+    } else if (threads_count_ > 1) {
+      // 遥测、图像各一个 strand
+      for (size_t i = 1; i < kEventLaneCount; ++i)
+        strands_.emplace_back(asio::make_strand(io_context_));
+    }
+  }
 
   ~EventManager() {
     stop();
@@ -53,53 +93,74 @@ class EventManager {
   void start() {
     if (running_.load()) return;
     running_.store(true);
-    thread_ = std::thread([this] { io_context_.run(); });
+    if (ring_) {
+      ring_->start(cpuOf(0));
+      return;
+    }
+    for (size_t i = 0; i < threads_count_; ++i) {
+      int cpu = cpuOf(i);
+      threads_.emplace_back([this, cpu] {
+        utils::pinCurrentThread(cpu);
+        currentManager() = this;
+        io_context_.run();
+        currentManager() = nullptr;
+      });
+    }
   }
 
   void stop() {
     if (!running_.load()) return;
     running_.store(false);
+    if (ring_) {
+      ring_->stop();
+      return;
+    }
+    queue_.close();
     work_guard_.reset();
     io_context_.stop();
-    if (thread_.joinable()) thread_.join();
+    {
+      // 唤醒在屏障处等待的事件线程，未执行的事件随 io_context 一起丢弃
+      std::lock_guard<std::mutex> lock(fence_mutex_);
+      fence_stopped_ = true;
+    }
+    fence_cv_.notify_all();
+    for (auto &thread : threads_) {
+      if (thread.joinable()) thread.join();
+    }
+    threads_.clear();
   }
 
+  // LockFree 后端须在 start 之前注册，运行中注册时抛出 std::logic_error
   void addCallback(std::shared_ptr<EventMessage> cb) {
+    if (ring_ && running_.load())
+      throw std::logic_error("LockFree backend callbacks must be added before start");
+    // 回调列表只在事件线程中读取，运行中注册时交给事件线程修改
+    if (!ring_ && running_.load()) {
+      exclusive([this, cb] { callbacks_.push_back(cb); });
+      return;
+    }
     callbacks_.push_back(cb);
+  }
 
-    // 注册事件
-    matchStartSignal_.connect([cb]() { cb->matchStartCallback(); });
-    matchEndSignal_.connect([cb]() { cb->matchEndCallback(); });
-    cameraStreamSignal_.connect(
-        [cb](const cv::Mat &l, const cv::Mat &r) { cb->cameraStreamCallback(l, r); });
-    ballPositionSignal_.connect([cb](const cv::Point2f &l, const cv::Point2f &r) {
-      cb->ballPositionCallback(l, r);
-    });
-    // predTrackBallSignal_.connect([cb](const std::vector<cv::Point3f> &pos) {
-    //   cb->predTrackBallPositionCallback(pos);
-    // });
-    // realTrackBallSignal_.connect([cb](const std::vector<cv::Point3f> &pos) {
-    //   cb->realTrackBallPositionCallback(pos);
-    // });
-    // shuttlecockSignal_.connect(
-    //     [cb](const cv::Point3f &pos) { cb->shuttlecockPositionCallback(pos); });
+  // 触发强类型事件，如 emit<BallPositionEvent>(leftPos, rightPos)
+  template <typename Event, typename... Args>
+  void emit(Args &&...args) {
+    send(Event{std::forward<Args>(args)...});
   }
 
-  // 触发事件函数
+  // 以下为兼容接口，事件类型与参数不匹配时抛出异常
   void emit(EnumEventType type) {
     if (type == EnumEventType::MatchStart)
-      io_context_.post([this] { matchStartSignal_(); });
+      emit<MatchStartEvent>();
     else if (type == EnumEventType::MatchEnd)
-      io_context_.post([this] { matchEndSignal_(); });
+      emit<MatchEndEvent>();
     else
       throw std::runtime_error("Invalid event type for no-arg emit");
   }
 
   void emit(EnumEventType type, const cv::Mat &leftFrame, const cv::Mat &rightFrame) {
     if (type == EnumEventType::CameraStream)
-      io_context_.post([this, leftFrame, rightFrame] {
-        cameraStreamSignal_(leftFrame, rightFrame);
-      });
+      emit<CameraStreamEvent>(leftFrame, rightFrame);
     else
       throw std::runtime_error("Invalid event type for Mat emit");
   }
@@ -107,47 +168,261 @@ class EventManager {
   void emit(
       EnumEventType type, const cv::Point2f &leftPos, const cv::Point2f &rightPos) {
     if (type == EnumEventType::BallPosition)
-      io_context_.post(
-          [this, leftPos, rightPos] { ballPositionSignal_(leftPos, rightPos); });
+      emit<BallPositionEvent>(leftPos, rightPos);
     else
       throw std::runtime_error("Invalid event type for Point2f emit");
   }
 
+  // 轨迹点拷贝到池化缓冲区，不超过预留容量时不分配内存
   void emit(EnumEventType type, const std::vector<cv::Point3f> &pos) {
+    bool track = type == EnumEventType::PredTrackBallPosition ||
+                 type == EnumEventType::RealTrackBallPosition;
+    if (!track) throw std::runtime_error("Invalid event type for vector<Point3f> emit");
+
+    TrackPoints points = acquireTrackPoints();
+    points->assign(pos.begin(), pos.end());
     if (type == EnumEventType::PredTrackBallPosition)
-      io_context_.post([this, pos] { predTrackBallSignal_(pos); });
-    else if (type == EnumEventType::RealTrackBallPosition)
-      io_context_.post([this, pos] { realTrackBallSignal_(pos); });
+      emit<PredTrackBallPositionEvent>(std::move(points));
     else
-      throw std::runtime_error("Invalid event type for vector<Point3f> emit");
+      emit<RealTrackBallPositionEvent>(std::move(points));
+  }
+
+  // 发送帧池中的图像，槽位在所有回调及其保留的引用释放后归还
+  void emit(FrameSlot slot) {
+    emit<CameraStreamEvent>(std::move(slot.left), std::move(slot.right));
   }
 
   void emit(EnumEventType type, const cv::Point3f &pos) {
     if (type == EnumEventType::ShuttlecockPosition)
-      io_context_.post([this, pos] { shuttlecockSignal_(pos); });
+      emit<ShuttlecockPositionEvent>(pos);
     else
       throw std::runtime_error("Invalid event type for Point3f emit");
   }
 
+  // 取得空的轨迹点缓冲区，填充后通过 emit<PredTrackBallPositionEvent> 等发送
+  TrackPoints acquireTrackPoints() {
+    TrackPoints points = track_pool_.acquire();
+    points->clear();
+    points->reserve(reserve_points_);
+    return points;
+  }
+
+  // 从帧池取得一对图像，写入后通过 emit(FrameSlot) 发送。
+  // 槽位全部占用时等待至多 timeoutMs 毫秒（小于 0 时一直等待），超时或未配置帧池时返回空槽位
+  FrameSlot acquireFrame(int timeoutMs = -1) {
+    return frame_pool_.acquire(timeoutMs);
+  }
+
+  const FramePool &framePool() const {
+    return frame_pool_;
+  }
+
   size_t poll() {
+    if (ring_) return ring_->poll();
+    if (!strands_.empty()) return 0;
     return io_context_.poll();
   }
 
+  // 队列长度、高水位及丢弃计数，Asio 后端包含各优先级通道的排队数和等待时间
+  EventQueueStats queueStats() const {
+    if (ring_) return ring_->stats();
+    EventQueueStats stats = queue_.stats();
+    lanes_.fill(stats.lanes);
+    return stats;
+  }
+
+ private:
+  template <typename Event>
+  void send(Event event) {
+    typedef EventTraits<Event> Traits;
+    if (ring_) {
+      ring_->push(Traits::kType, 0, [&event](EventRecord &rec) { store(rec, event); });
+      return;
+    }
+    auto enqueued = PipelineMetrics::Clock::now();
+    post(Traits::kType, enqueued, [this, event, enqueued] {
+      if (metrics_) metrics_->record(PipelineStage::Queue, Traits::kType, enqueued);
+      event_clock::CaptureScope capture(enqueued);
+      for (const auto &cb : callbacks_) Traits::dispatch(*cb, event);
+    });
+  }
+
+  // 图像按字节数限制队列
+  void send(CameraStreamEvent event) {
+    if (ring_) {
+      size_t bytes =
+          EventQueue::matBytes(event.leftFrame) + EventQueue::matBytes(event.rightFrame);
+      ring_->push(EnumEventType::CameraStream, bytes, [&event](EventRecord &rec) {
+        store(rec, event);
+      });
+      return;
+    }
+    auto frame = queue_.admitFrame(event.leftFrame, event.rightFrame, mayBlock());
+    if (!frame) return;
+    auto enqueued = PipelineMetrics::Clock::now();
+    execute(EnumEventType::CameraStream, enqueued, [this, frame, enqueued] {
+      if (!queue_.takeFrame(frame)) return;
+      if (metrics_)
+        metrics_->record(PipelineStage::Queue, EnumEventType::CameraStream, enqueued);
+      event_clock::CaptureScope capture(enqueued);
+      for (const auto &cb : callbacks_) cb->cameraStreamCallback(frame->left, frame->right);
+    });
+  }
+
+  // 写入环形队列记录，dispatch 按事件类型直接调用对应回调
+  static void store(EventRecord &rec, const MatchStartEvent &) {
+    rec.dispatch = [](EventMessage &cb, const EventRecord &) {
+      cb.matchStartCallback();
+    };
+  }
+  static void store(EventRecord &rec, const MatchEndEvent &) {
+    rec.dispatch = [](EventMessage &cb, const EventRecord &) {
+      cb.matchEndCallback();
+    };
+  }
+  static void store(EventRecord &rec, const CameraStreamEvent &event) {
+    rec.leftFrame = event.leftFrame;
+    rec.rightFrame = event.rightFrame;
+    rec.dispatch = [](EventMessage &cb, const EventRecord &r) {
+      cb.cameraStreamCallback(r.leftFrame, r.rightFrame);
+    };
+  }
+  static void store(EventRecord &rec, const BallPositionEvent &event) {
+    rec.leftPos = event.leftPos;
+    rec.rightPos = event.rightPos;
+    rec.dispatch = [](EventMessage &cb, const EventRecord &r) {
+      cb.ballPositionCallback(r.leftPos, r.rightPos);
+    };
+  }
+  static void store(EventRecord &rec, const PredTrackBallPositionEvent &event) {
+    rec.points.assign(event.positions->begin(), event.positions->end());
+    rec.dispatch = [](EventMessage &cb, const EventRecord &r) {
+      cb.predTrackBallPositionCallback(r.points);
+    };
+  }
+  static void store(EventRecord &rec, const RealTrackBallPositionEvent &event) {
+    rec.points.assign(event.positions->begin(), event.positions->end());
+    rec.dispatch = [](EventMessage &cb, const EventRecord &r) {
+      cb.realTrackBallPositionCallback(r.points);
+    };
+  }
+  static void store(EventRecord &rec, const ShuttlecockPositionEvent &event) {
+    rec.point = event.position;
+    rec.dispatch = [](EventMessage &cb, const EventRecord &r) {
+      cb.shuttlecockPositionCallback(r.point);
+    };
+  }
+
+  template <typename Handler>
+  void post(
+      EnumEventType type,
+      PipelineMetrics::Clock::time_point enqueued,
+      Handler handler) {
+    if (!queue_.admit(type, mayBlock())) return;
+    execute(type, enqueued, [this, handler] {
+      queue_.release();
+      handler();
+    });
+  }
+
+  // 单线程时放入优先级通道，每个事件投递一次 dispatchLane，执行时取优先级最高的事件；
+  // 没有等待中的事件时直接投递，不经过通道。
+  // 多线程时投递到事件所属通道的 strand，比赛开始/结束经屏障执行
+  template <typename Handler>
+  void execute(
+      EnumEventType type,
+      PipelineMetrics::Clock::time_point enqueued,
+      Handler handler) {
+    EventLane lane = laneOf(type);
+    if (strands_.empty()) {
+      if (lanes_.tryBypass(lane)) {
+        io_context_.post([this, lane, enqueued, handler] {
+          lanes_.dispatched(lane, enqueued);
+          handler();
+          lanes_.bypassed();
+        });
+        return;
+      }
+      lanes_.push(lane, handler, enqueued);
+      io_context_.post([this] { lanes_.dispatch(); });
+      return;
+    }
+    lanes_.pushed(lane);
+    auto counted = [this, lane, enqueued, handler] {
+      lanes_.dispatched(lane, enqueued);
+      handler();
+    };
+    if (lane == EventLane::Control)
+      exclusive(counted);
+    else
+      asio::post(strands_[static_cast<size_t>(lane) - 1], counted);
+  }
+
+  // 屏障：在每个 strand 上排队，最后到达的线程执行 handler，其余线程等待其完成，
+  // 因此 handler 在各 strand 之前的事件之后、之后的事件之前执行，且不与其他回调并发。
+  // 每个 strand 最多占用一个线程等待，线程数不少于 strand 数时不会死锁
+  template <typename Handler>
+  void exclusive(Handler handler) {
+    if (strands_.empty()) {
+      io_context_.post(handler);
+      return;
+    }
+    struct Fence {
+      size_t remaining;
+      bool done = false;
+    };
+    auto fence = std::make_shared<Fence>();
+    fence->remaining = strands_.size();
+    for (auto &strand : strands_) {
+      asio::post(strand, [this, fence, handler] {
+        std::unique_lock<std::mutex> lock(fence_mutex_);
+        if (--fence->remaining > 0) {
+          fence_cv_.wait(lock, [&] { return fence->done || fence_stopped_; });
+          return;
+        }
+        lock.unlock();
+        handler();
+        lock.lock();
+        fence->done = true;
+        fence_cv_.notify_all();
+      });
+    }
+  }
+
+  // 事件线程内 emit 时阻塞会导致死锁
+  bool mayBlock() const {
+    return running_.load() && currentManager() != this;
+  }
+
+  int cpuOf(size_t thread) const {
+    return cpus_.empty() ? -1 : cpus_[thread % cpus_.size()];
+  }
+
+  // 当前线程所属的 EventManager，非事件线程为空
+  static const EventManager *&currentManager() {
+    static thread_local const EventManager *manager = nullptr;
+    return manager;
+  }
+
  private:
   asio::io_context io_context_;
   asio::executor_work_guard<asio::io_context::executor_type> work_guard_;
-  std::thread thread_;
+  std::vector<std::thread> threads_;
+  std::vector<asio::strand<asio::io_context::executor_type>> strands_;
+  std::mutex fence_mutex_;
+  std::condition_variable fence_cv_;
+  bool fence_stopped_ = false;
   std::atomic<bool> running_;
   std::vector<std::shared_ptr<EventMessage>> callbacks_;
-
-  // 信号定义
-  signals2::signal<void()> matchStartSignal_;
-  signals2::signal<void()> matchEndSignal_;
-  signals2::signal<void(const cv::Mat &, const cv::Mat &)> cameraStreamSignal_;
-  signals2::signal<void(const cv::Point2f &, const cv::Point2f &)> ballPositionSignal_;
-  signals2::signal<void(const std::vector<cv::Point3f> &)> predTrackBallSignal_;
-  signals2::signal<void(const std::vector<cv::Point3f> &)> realTrackBallSignal_;
-  signals2::signal<void(const cv::Point3f &)> shuttlecockSignal_;
+  EventQueue queue_;
+  std::unique_ptr<RingDispatcher> ring_;
+  TrackPointPool track_pool_;
+  FramePool frame_pool_;
+  const size_t reserve_points_;
+  std::shared_ptr<PipelineMetrics> metrics_;
+  const size_t threads_count_;
+  const std::vector<int> cpus_;
+  EventLanes lanes_;
 };
 
 };  // namespace hook_event::event
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "../publisher/base_publisher.hpp"
+
+namespace hook_event::event {
+
+// 遥测批次自适应调整
+// librdkafka 的 linger.ms、batch.size 在 producer 创建后不能修改，因此调整的是
+// TelemetryBatcher 的每批条数和最长等待时间：延迟未超出目标时加大批次以减少消息数，
+// 延迟超出目标或 producer 队列积压时成倍减小。
+struct AdaptiveBatchConfig {
+  bool enabled = false;
+  // 目标延迟，毫秒：批次等待时间 + 入队到 broker 确认的耗时
+  int targetLatencyMs = 50;
+  // 每批条数及等待时间的范围
+  size_t minItems = 1;
+  size_t maxItems = 64;
+  int minDelayMs = 1;
+  int maxDelayMs = 50;
+  // 调整周期，毫秒
+  int intervalMs = 1000;
+  // producer 队列中的消息数超过该值视为积压，0 表示不检查
+  uint64_t maxQueueMessages = 10000;
+  // librdkafka 批次平均字节数达到该值时不再加大批次，0 表示不检查
+  int64_t maxBatchBytes = 512 * 1024;
+};
+
+// 当前批次参数
+struct BatchLimits {
+  size_t items = 1;
+  int delayMs = 1;
+};
+
+// 每个周期根据发布统计给出批次参数（加性增、乘性减），非线程安全
+class BatchController {
+ public:
+  explicit BatchController(const AdaptiveBatchConfig &config)
+      : config_(normalize(config)) {
+    limits_.items = config_.minItems;
+    limits_.delayMs = config_.minDelayMs;
+  }
+
+  // 以指定参数开始，超出范围时取边界值
+  BatchController(const AdaptiveBatchConfig &config, BatchLimits initial)
+      : BatchController(config) {
+    limits_.items = clamp(initial.items, config_.minItems, config_.maxItems);
+    limits_.delayMs = clamp(initial.delayMs, config_.minDelayMs, config_.maxDelayMs);
+  }
+
+  const BatchLimits &limits() const {
+    return limits_;
+  }
+
+  // 本周期估计的延迟，微秒
+  int64_t latencyUs() const {
+    return latency_us_;
+  }
+
+  // stats 为发布器的累计统计，参数变化时返回 true，reason 为调整原因
+  bool update(const publisher::PublisherStats &stats, std::string *reason = nullptr) {
+    // 累计值按周期差分得到本周期的平均确认耗时
+    uint64_t delivered = stats.delivered - last_delivered_;
+    uint64_t latencySum = stats.totalLatencyUs - last_latency_us_;
+    last_delivered_ = stats.delivered;
+    last_latency_us_ = stats.totalLatencyUs;
+    int64_t deliveryUs = delivered ? static_cast<int64_t>(latencySum / delivered) : 0;
+    deliveryUs = std::max(deliveryUs, stats.rttP99Us);
+    latency_us_ = deliveryUs + limits_.delayMs * 1000LL;
+
+    BatchLimits next = limits_;
+    int64_t targetUs = config_.targetLatencyMs * 1000LL;
+    const char *why = nullptr;
+    bool backlog =
+        config_.maxQueueMessages && stats.queueMessages > config_.maxQueueMessages;
+    if (backlog || latency_us_ > targetUs) {
+      why = backlog ? "queue backlog" : "latency above target";
+      next.items = std::max(config_.minItems, next.items / 2);
+      next.delayMs = std::max(config_.minDelayMs, next.delayMs / 2);
+    } else if (!config_.maxBatchBytes || stats.batchSizeAvg < config_.maxBatchBytes) {
+      // 条数只决定何时提前输出，不增加延迟；等待时间只在延迟低于目标一半时加大，
+      // 且不超过目标减去确认耗时
+      why = "latency headroom";
+      next.items = std::min(config_.maxItems, next.items + itemStep());
+      if (latency_us_ * 2 < targetUs) {
+        int headroomMs = static_cast<int>((targetUs - deliveryUs) / 1000);
+        int cap = std::min(config_.maxDelayMs, headroomMs);
+        int grown = std::min(cap, next.delayMs + delayStep());
+        next.delayMs = std::max(next.delayMs, grown);
+      }
+    }
+
+    if (next.items == limits_.items && next.delayMs == limits_.delayMs) return false;
+    if (reason) {
+      char buf[192];
+      std::snprintf(
+          buf,
+          sizeof(buf),
+          "items %zu -> %zu, delay %d -> %d ms (%s: latency %.1f ms, target %d ms, "
+          "queue %llu)",
+          limits_.items,
+          next.items,
+          limits_.delayMs,
+          next.delayMs,
+          why,
+          latency_us_ / 1000.0,
+          config_.targetLatencyMs,
+          static_cast<unsigned long long>(stats.queueMessages));
+      *reason = buf;
+    }
+    limits_ = next;
+    return true;
+  }
+
+ private:
+  static AdaptiveBatchConfig normalize(AdaptiveBatchConfig config) {
+    config.minItems = std::max<size_t>(1, config.minItems);
+    config.maxItems = std::max(config.minItems, config.maxItems);
+    config.minDelayMs = std::max(1, config.minDelayMs);
+    // 等待时间本身不超过目标延迟
+    config.maxDelayMs = std::min(config.maxDelayMs, config.targetLatencyMs);
+    config.maxDelayMs = std::max(config.minDelayMs, config.maxDelayMs);
+    return config;
+  }
+
+  template <typename T>
+  static T clamp(T value, T low, T high) {
+    return std::min(high, std::max(low, value));
+  }
+
+  // 约 8 个周期从下限增长到上限
+  size_t itemStep() const {
+    return std::max<size_t>(1, (config_.maxItems - config_.minItems) / 8);
+  }
+
+  int delayStep() const {
+    return std::max(1, (config_.maxDelayMs - config_.minDelayMs) / 8);
+  }
+
+  const AdaptiveBatchConfig config_;
+  BatchLimits limits_;
+  int64_t latency_us_ = 0;
+  uint64_t last_delivered_ = 0;
+  uint64_t last_latency_us_ = 0;
+};
+
+};  // namespace hook_event::event
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace hook_event::event {
+
+// 事件采集时间
+// EventManager 在 emit 时记录单调时钟，分发时通过 CaptureScope 设置给当前线程，
+// 回调中由 captureWallUs 换算为墙上时间：换算在同一进程内完成，
+// 不受 emit 之后系统时间调整的影响，可与其他进程的墙上时间比较。
+namespace event_clock {
+
+typedef std::chrono::steady_clock Clock;
+
+// HookEventPublisher 写入的 Kafka 消息头，值为十进制字符串
+const char *const kHeaderEvent = "hk-event";           /// 事件名，如 ball_position
+const char *const kHeaderCaptureUs = "hk-capture-us";  /// 采集时间，Unix 微秒
+const char *const kHeaderPublishUs = "hk-publish-us";  /// 交给发布器的时间，Unix 微秒
+
+// 当前墙上时间，Unix 微秒
+inline int64_t wallUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// 当前线程正在分发的事件的 emit 时刻，未在分发中时为默认值
+inline Clock::time_point &current() {
+  static thread_local Clock::time_point captured;
+  return captured;
+}
+
+// 作用域内的回调读取到的采集时间为 captured
+class CaptureScope {
+ public:
+  explicit CaptureScope(Clock::time_point captured) : previous_(current()) {
+    current() = captured;
+  }
+
+  ~CaptureScope() {
+    current() = previous_;
+  }
+
+  CaptureScope(const CaptureScope &) = delete;
+  CaptureScope &operator=(const CaptureScope &) = delete;
+
+ private:
+  Clock::time_point previous_;
+};
+
+// 当前事件的 emit 时刻，不在分发中时为当前时间
+inline Clock::time_point captureTime() {
+  Clock::time_point captured = current();
+  return captured == Clock::time_point() ? Clock::now() : captured;
+}
+
+// 当前事件 emit 时刻的墙上时间（Unix 微秒），不在分发中（如直接调用回调）时为当前时间
+inline int64_t captureWallUs() {
+  Clock::time_point captured = current();
+  int64_t now = wallUs();
+  if (captured == Clock::time_point()) return now;
+  return now -
+         std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - captured)
+             .count();
+}
+
+};  // namespace event_clock
+
+};  // namespace hook_event::event
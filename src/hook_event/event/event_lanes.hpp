@@ -0,0 +1,275 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+#include "../utils/histogram.hpp"
+#include "./event_type.hpp"
+
+namespace hook_event::event {
+
+// 事件优先级通道，数值越小优先级越高
+enum class EventLane {
+  Control = 0,  /// 比赛开始/结束
+  Telemetry,    /// 球位置、轨迹、击球点
+  Media,        /// 摄像头图像
+};
+
+const size_t kEventLaneCount = static_cast<size_t>(EventLane::Media) + 1;
+
+inline EventLane laneOf(EnumEventType type) {
+  if (isControlEvent(type)) return EventLane::Control;
+  return type == EnumEventType::CameraStream ? EventLane::Media : EventLane::Telemetry;
+}
+
+inline const char *laneName(EventLane lane) {
+  switch (lane) {
+    case EventLane::Control:
+      return "control";
+    case EventLane::Telemetry:
+      return "telemetry";
+    case EventLane::Media:
+      return "media";
+  }
+  return "";
+}
+
+struct EventLaneStats {
+  size_t events = 0;           /// 当前排队事件数
+  size_t highWaterEvents = 0;  /// 排队事件数高水位
+  uint64_t dispatched = 0;     /// 已分发事件数
+  // 入队到开始分发的等待时间，单位微秒
+  utils::HistogramSnapshot waitUs;
+};
+
+// 分通道的就绪队列
+// dispatch 优先取高优先级通道；低优先级通道有等待事件时，高优先级通道连续分发
+// starvationLimit 个事件后让出一次。控制事件作为屏障：在它之前 push 的事件全部分发后
+// 才分发，之后 push 的事件不会先于它分发，因此比赛开始/结束与其他事件的先后顺序不变。
+// 各通道内按 push 顺序分发。
+//
+// handler 原地构造在复用的节点中，不经过 std::function，稳定状态下不分配内存。
+// 没有任何等待事件时调用方可通过 tryBypass 跳过就绪队列直接执行，此时无需排序。
+class EventLanes {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  // 可放入节点的 handler 大小上限
+  static const size_t kHandlerSize = 128;
+
+  explicit EventLanes(size_t starvationLimit = 16)
+      : starvation_limit_(starvationLimit ? starvationLimit : 1) {
+    for (size_t i = 0; i < kEventLaneCount; ++i) {
+      events_[i].store(0);
+      high_water_[i].store(0);
+      dispatched_[i].store(0);
+    }
+  }
+
+  EventLanes(const EventLanes &) = delete;
+  EventLanes &operator=(const EventLanes &) = delete;
+
+  ~EventLanes() {
+    for (size_t i = 0; i < kEventLaneCount; ++i) {
+      while (Node *node = queues_[i].head) {
+        queues_[i].head = node->next;
+        node->run(node, false);
+        delete node;
+      }
+    }
+    while (Node *node = free_) {
+      free_ = node->next;
+      delete node;
+    }
+  }
+
+  // enqueued 为事件入队时刻，用于统计等待时间
+  template <typename Handler>
+  void push(
+      EventLane lane, Handler handler, Clock::time_point enqueued = Clock::now()) {
+    static_assert(sizeof(Handler) <= kHandlerSize, "handler too large for EventLanes");
+    static_assert(
+        alignof(Handler) <= alignof(std::max_align_t),
+        "handler over-aligned for EventLanes");
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node *node = free_;
+    if (node)
+      free_ = node->next;
+    else
+      node = new Node();
+    new (&node->storage) Handler(std::move(handler));
+    node->run = &runHandler<Handler>;
+    node->next = nullptr;
+    node->seq = next_seq_++;
+    node->enqueued = enqueued;
+    Queue &queue = queues_[index(lane)];
+    if (queue.tail)
+      queue.tail->next = node;
+    else
+      queue.head = node;
+    queue.tail = node;
+    ++pending_;
+    pushed(lane);
+  }
+
+  // 分发下一个应分发的事件，没有时返回 false
+  bool dispatch() {
+    Node *node;
+    EventLane lane;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!take(node, lane)) return false;
+    }
+    dispatched(lane, node->enqueued);
+    Recycle recycle{this, node};
+    node->run(node, true);
+    return true;
+  }
+
+  // 没有等待中（含正在执行）的事件时返回 true，调用方直接执行该事件：
+  // 开始时调用 dispatched，结束后调用 bypassed。之后 push 的事件排在它之后，
+  // 顺序与经过就绪队列时相同
+  bool tryBypass(EventLane lane) {
+    size_t idle = 0;
+    if (!pending_.compare_exchange_strong(idle, 1)) return false;
+    pushed(lane);
+    return true;
+  }
+
+  void bypassed() {
+    --pending_;
+  }
+
+  // 不经过就绪队列的事件（如多线程 strand）只统计排队数和等待时间
+  void pushed(EventLane lane) {
+    size_t events = ++events_[index(lane)];
+    std::atomic<size_t> &mark = high_water_[index(lane)];
+    size_t current = mark.load(std::memory_order_relaxed);
+    while (events > current &&
+           !mark.compare_exchange_weak(current, events, std::memory_order_relaxed)) {
+    }
+  }
+
+  void dispatched(EventLane lane, Clock::time_point enqueued) {
+    --events_[index(lane)];
+    dispatched_[index(lane)].fetch_add(1, std::memory_order_relaxed);
+    wait_[index(lane)].record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - enqueued)
+            .count()));
+  }
+
+  void fill(EventLaneStats (&stats)[kEventLaneCount]) const {
+    for (size_t i = 0; i < kEventLaneCount; ++i) {
+      stats[i].events = events_[i].load();
+      stats[i].highWaterEvents = high_water_[i].load();
+      stats[i].dispatched = dispatched_[i].load();
+      stats[i].waitUs = wait_[i].snapshot();
+    }
+  }
+
+ private:
+  struct Node {
+    Node *next = nullptr;
+    uint64_t seq = 0;
+    Clock::time_point enqueued;
+    // invoke 为 true 时执行 handler，之后析构
+    void (*run)(Node *node, bool invoke) = nullptr;
+    typename std::aligned_storage<kHandlerSize>::type storage;
+  };
+
+  struct Queue {
+    Node *head = nullptr;
+    Node *tail = nullptr;
+  };
+
+  // 执行结束（含异常）后归还节点
+  struct Recycle {
+    EventLanes *lanes;
+    Node *node;
+    ~Recycle() {
+      std::lock_guard<std::mutex> lock(lanes->mutex_);
+      node->next = lanes->free_;
+      lanes->free_ = node;
+      --lanes->pending_;
+    }
+  };
+
+  template <typename Handler>
+  static void runHandler(Node *node, bool invoke) {
+    Handler *handler = reinterpret_cast<Handler *>(&node->storage);
+    if (invoke) {
+      // 异常时也须析构
+      struct Destroy {
+        Handler *handler;
+        ~Destroy() {
+          handler->~Handler();
+        }
+      } destroy{handler};
+      (*handler)();
+      return;
+    }
+    handler->~Handler();
+  }
+
+  static size_t index(EventLane lane) {
+    return static_cast<size_t>(lane);
+  }
+
+  // 须持有 mutex_
+  bool take(Node *&node, EventLane &lane) {
+    const Queue &control = queues_[index(EventLane::Control)];
+    uint64_t barrier = control.head ? control.head->seq : UINT64_MAX;
+
+    // 屏障之前的非控制事件
+    bool eligible[kEventLaneCount] = {};
+    size_t first = kEventLaneCount;
+    for (size_t i = index(EventLane::Telemetry); i < kEventLaneCount; ++i) {
+      eligible[i] = queues_[i].head && queues_[i].head->seq < barrier;
+      if (eligible[i] && first == kEventLaneCount) first = i;
+    }
+    size_t chosen = first;
+    if (chosen == kEventLaneCount) {
+      if (!control.head) return false;
+      chosen = index(EventLane::Control);
+    } else {
+      // 等待过久的低优先级通道先分发
+      for (size_t i = kEventLaneCount - 1; i > first; --i) {
+        if (eligible[i] && skipped_[i] >= starvation_limit_) {
+          chosen = i;
+          break;
+        }
+      }
+      for (size_t i = chosen + 1; i < kEventLaneCount; ++i) {
+        if (eligible[i]) ++skipped_[i];
+      }
+      skipped_[chosen] = 0;
+    }
+
+    Queue &queue = queues_[chosen];
+    node = queue.head;
+    queue.head = node->next;
+    if (!queue.head) queue.tail = nullptr;
+    lane = static_cast<EventLane>(chosen);
+    return true;
+  }
+
+  const size_t starvation_limit_;
+  std::mutex mutex_;
+  Queue queues_[kEventLaneCount];
+  Node *free_ = nullptr;
+  size_t skipped_[kEventLaneCount] = {};
+  uint64_t next_seq_ = 0;
+  // 就绪队列及直接执行中的事件数
+  std::atomic<size_t> pending_{0};
+  std::atomic<size_t> events_[kEventLaneCount];
+  std::atomic<size_t> high_water_[kEventLaneCount];
+  std::atomic<uint64_t> dispatched_[kEventLaneCount];
+  utils::Histogram wait_[kEventLaneCount];
+};
+
+};  // namespace hook_event::event
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+namespace hook_event::event {
+
+class EventMessage {
+ public:
+  virtual void matchStartCallback() {};
+  virtual void matchEndCallback() {};
+  virtual void cameraStreamCallback(
+      const cv::Mat &leftFrame, const cv::Mat &rightFrame) {};
+  virtual void ballPositionCallback(
+      const cv::Point2f &leftPos, const cv::Point2f &rightPos) {};
+  virtual void predTrackBallPositionCallback(const std::vector<cv::Point3f> &pos) {};
+  virtual void realTrackBallPositionCallback(const std::vector<cv::Point3f> &pos) {};
+  virtual void shuttlecockPositionCallback(const cv::Point3f &pos) {};
+};
+
+};  // namespace hook_event::event
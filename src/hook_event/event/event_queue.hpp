@@ -0,0 +1,216 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+
+#include "./event_lanes.hpp"
+#include "./event_type.hpp"
+
+namespace hook_event::event {
+
+// 队列满时的处理策略
+enum class OverflowPolicy {
+  Block = 0,   /// 阻塞 emit 直到队列有空间
+  DropOldest,  /// 丢弃队列中最早的摄像头帧
+  DropNewest,  /// 丢弃当前事件
+};
+
+struct EventQueueConfig {
+  // 排队事件数上限，0 表示不限制
+  size_t maxEvents = 0;
+  // 排队图像数据字节数上限，0 表示不限制
+  size_t maxFrameBytes = 0;
+  // 各事件类型的溢出策略，未配置的使用 defaultPolicy
+  // MatchStart / MatchEnd 为控制事件，始终入队，不受限制
+  std::map<EnumEventType, OverflowPolicy> policies = {
+      {EnumEventType::CameraStream, OverflowPolicy::DropOldest},
+  };
+  OverflowPolicy defaultPolicy = OverflowPolicy::Block;
+
+  OverflowPolicy policy(EnumEventType type) const {
+    auto it = policies.find(type);
+    return it == policies.end() ? defaultPolicy : it->second;
+  }
+};
+
+struct EventQueueStats {
+  size_t events = 0;               /// 当前排队事件数
+  size_t frameBytes = 0;           /// 当前排队图像字节数
+  size_t highWaterEvents = 0;      /// 排队事件数高水位
+  size_t highWaterFrameBytes = 0;  /// 排队图像字节数高水位
+  uint64_t blocked = 0;            /// emit 因队列满而阻塞的次数
+  uint64_t emitted[kEventTypeCount] = {};
+  uint64_t dropped[kEventTypeCount] = {};
+  // 各优先级通道，仅 Asio 后端统计
+  EventLaneStats lanes[kEventLaneCount];
+
+  uint64_t totalDropped() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < kEventTypeCount; ++i) total += dropped[i];
+    return total;
+  }
+};
+
+// 排队中的双目帧，DropOldest 时可被撤销
+struct QueuedFrame {
+  cv::Mat left;
+  cv::Mat right;
+  size_t bytes = 0;
+  bool dropped = false;
+};
+
+// 事件队列容量控制
+// 入队前调用 admit / admitFrame，出队时调用 release / takeFrame。
+class EventQueue {
+ public:
+  explicit EventQueue(const EventQueueConfig &config) : config_(config) {}
+
+  // 返回 false 表示事件被丢弃
+  bool admit(EnumEventType type, bool mayBlock) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!makeRoom(lock, type, 0, mayBlock)) return false;
+    push(type, 0);
+    return true;
+  }
+
+  // 返回 nullptr 表示帧被丢弃
+  std::shared_ptr<QueuedFrame> admitFrame(
+      const cv::Mat &left, const cv::Mat &right, bool mayBlock) {
+    size_t bytes = matBytes(left) + matBytes(right);
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!makeRoom(lock, EnumEventType::CameraStream, bytes, mayBlock)) return nullptr;
+
+    auto frame = std::make_shared<QueuedFrame>();
+    frame->left = left;
+    frame->right = right;
+    frame->bytes = bytes;
+    frames_.push_back(frame);
+    push(EnumEventType::CameraStream, bytes);
+    return frame;
+  }
+
+  void release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pop(0);
+  }
+
+  // 返回 false 表示该帧已被 DropOldest 撤销
+  bool takeFrame(const std::shared_ptr<QueuedFrame> &frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (frame->dropped) return false;
+    if (!frames_.empty() && frames_.front() == frame) {
+      frames_.pop_front();
+    } else {
+      for (auto it = frames_.begin(); it != frames_.end(); ++it) {
+        if (*it != frame) continue;
+        frames_.erase(it);
+        break;
+      }
+    }
+    pop(frame->bytes);
+    return true;
+  }
+
+  // 唤醒所有阻塞的 emit，之后不再阻塞
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    spaceCv_.notify_all();
+  }
+
+  EventQueueStats stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  const EventQueueConfig &config() const {
+    return config_;
+  }
+
+  static size_t matBytes(const cv::Mat &mat) {
+    return mat.empty() ? 0 : mat.total() * mat.elemSize();
+  }
+
+ private:
+  bool fits(size_t bytes) const {
+    if (config_.maxEvents && stats_.events >= config_.maxEvents) return false;
+    // 单帧超过上限时，队列中没有其他帧即可入队
+    if (config_.maxFrameBytes && bytes && stats_.frameBytes &&
+        stats_.frameBytes + bytes > config_.maxFrameBytes)
+      return false;
+    return true;
+  }
+
+  bool makeRoom(
+      std::unique_lock<std::mutex> &lock,
+      EnumEventType type,
+      size_t bytes,
+      bool mayBlock) {
+    if (isControlEvent(type)) return true;
+
+    bool waited = false;
+    while (!fits(bytes)) {
+      switch (config_.policy(type)) {
+        case OverflowPolicy::Block:
+          // 事件线程内 emit 或已停止时不能阻塞，直接入队
+          if (!mayBlock || closed_) return true;
+          if (!waited) ++stats_.blocked;
+          waited = true;
+          spaceCv_.wait(lock);
+          break;
+        case OverflowPolicy::DropOldest:
+          if (!frames_.empty()) {
+            dropOldestFrame();
+            break;
+          }
+          // 没有可丢弃的帧，丢弃当前事件
+          ++stats_.dropped[type];
+          return false;
+        case OverflowPolicy::DropNewest:
+          ++stats_.dropped[type];
+          return false;
+      }
+    }
+    return true;
+  }
+
+  void dropOldestFrame() {
+    auto frame = frames_.front();
+    frames_.pop_front();
+    frame->dropped = true;
+    frame->left.release();
+    frame->right.release();
+    ++stats_.dropped[EnumEventType::CameraStream];
+    pop(frame->bytes);
+  }
+
+  void push(EnumEventType type, size_t bytes) {
+    ++stats_.emitted[type];
+    ++stats_.events;
+    stats_.frameBytes += bytes;
+    if (stats_.events > stats_.highWaterEvents) stats_.highWaterEvents = stats_.events;
+    if (stats_.frameBytes > stats_.highWaterFrameBytes)
+      stats_.highWaterFrameBytes = stats_.frameBytes;
+  }
+
+  void pop(size_t bytes) {
+    --stats_.events;
+    stats_.frameBytes -= bytes;
+    spaceCv_.notify_all();
+  }
+
+ private:
+  const EventQueueConfig config_;
+  mutable std::mutex mutex_;
+  std::condition_variable spaceCv_;
+  std::deque<std::shared_ptr<QueuedFrame>> frames_;
+  EventQueueStats stats_;
+  bool closed_ = false;
+};
+
+};  // namespace hook_event::event
@@ -0,0 +1,483 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <opencv2/opencv.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../utils/buffer_pool.hpp"
+#include "./event_type.hpp"
+#include "./frame_message.hpp"
+
+namespace hook_event::event {
+
+// 遥测消息格式
+enum class TelemetryFormat {
+  Json = 0,  /// {"event","game_id","frame_id",...}
+  Binary,    /// 定长二进制，见 BinaryEventSerializer
+};
+
+// 除图像外的定长事件，按 type 解释各字段
+struct TelemetryEvent {
+  EnumEventType type = EnumEventType::MatchStart;
+  uint32_t gameId = 0;
+  uint32_t frameId = 0;
+  cv::Point2f left;                    /// BallPosition
+  cv::Point2f right;                   /// BallPosition
+  cv::Point3f position;                /// ShuttlecockPosition
+  std::vector<cv::Point3f> positions;  /// PredTrackBallPosition, RealTrackBallPosition
+  int64_t timestampUs = 0;             /// 采集时间，Unix 微秒，0 表示未记录
+};
+
+inline const char *eventName(EnumEventType type) {
+  switch (type) {
+    case EnumEventType::MatchStart:
+      return "match_start";
+    case EnumEventType::MatchEnd:
+      return "match_end";
+    case EnumEventType::CameraStream:
+      return "camera_stream";
+    case EnumEventType::BallPosition:
+      return "ball_position";
+    case EnumEventType::PredTrackBallPosition:
+      return "pred_track_ball_position";
+    case EnumEventType::RealTrackBallPosition:
+      return "real_track_ball_position";
+    case EnumEventType::ShuttlecockPosition:
+      return "shuttlecock_position";
+  }
+  return "";
+}
+
+inline bool eventType(const std::string &name, EnumEventType &type) {
+  for (size_t i = 0; i < kEventTypeCount; ++i) {
+    if (name == eventName(static_cast<EnumEventType>(i))) {
+      type = static_cast<EnumEventType>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+// 遥测事件序列化
+// 单条消息对应一个事件，批次消息包含多条同类型、同 game_id 的事件
+class EventSerializer {
+ public:
+  virtual ~EventSerializer() = default;
+
+  // 写入 out 末尾
+  virtual void encode(const TelemetryEvent &event, utils::ByteBuffer &out) const = 0;
+
+  // events 须为同类型、同 game_id
+  virtual void encodeBatch(
+      const TelemetryEvent *events, size_t count, utils::ByteBuffer &out) const = 0;
+
+  // 解析单条或批次消息
+  virtual bool decode(
+      const unsigned char *message,
+      size_t size,
+      std::vector<TelemetryEvent> &events) const = 0;
+};
+
+// 与原 nlohmann::json::dump 输出一致（键按字母序），直接写入缓冲区，不构建 json 对象
+//
+// 单条 {"event":"ball_position","frame_id":1,"game_id":1,"left":[x,y],"right":[x,y]}
+// 批次 {"event":"ball_position_batch","game_id":1,"items":[{"frame_id":1,...},...]}
+// 记录了采集时间时末尾增加 "timestamp"（Unix 毫秒），二进制格式不含采集时间
+class JsonEventSerializer : public EventSerializer {
+ public:
+  void encode(const TelemetryEvent &event, utils::ByteBuffer &out) const override {
+    out.append("{\"event\":\"");
+    out.append(eventName(event.type));
+    out.append("\",");
+    appendFields(event, out, true);
+    out.append("}");
+  }
+
+  void encodeBatch(
+      const TelemetryEvent *events,
+      size_t count,
+      utils::ByteBuffer &out) const override {
+    if (!count) return;
+    out.append("{\"event\":\"");
+    out.append(eventName(events[0].type));
+    out.append("_batch\",\"game_id\":");
+    appendUint(events[0].gameId, out);
+    out.append(",\"items\":[");
+    for (size_t i = 0; i < count; ++i) {
+      if (i) out.append(",");
+      out.append("{");
+      appendFields(events[i], out, false);
+      out.append("}");
+    }
+    out.append("]}");
+  }
+
+  bool decode(
+      const unsigned char *message,
+      size_t size,
+      std::vector<TelemetryEvent> &events) const override {
+    events.clear();
+    nlohmann::json msg = nlohmann::json::parse(message, message + size, nullptr, false);
+    const nlohmann::json *eventField = msg.is_object() ? field(msg, "event") : nullptr;
+    if (!eventField || !eventField->is_string()) return false;
+
+    std::string name = eventField->get<std::string>();
+    const std::string suffix = "_batch";
+    bool batch = name.size() > suffix.size() &&
+                 name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    if (batch) name.resize(name.size() - suffix.size());
+
+    TelemetryEvent event;
+    const nlohmann::json *gameId = field(msg, "game_id");
+    if (!eventType(name, event.type) || !gameId || !gameId->is_number_unsigned())
+      return false;
+    event.gameId = gameId->get<uint32_t>();
+    if (!batch) {
+      if (!parseFields(msg, event)) return false;
+      events.push_back(event);
+      return true;
+    }
+
+    const nlohmann::json *items = field(msg, "items");
+    if (!items || !items->is_array()) return false;
+    for (const auto &item : *items) {
+      TelemetryEvent decoded = event;
+      if (!parseFields(item, decoded)) return false;
+      events.push_back(decoded);
+    }
+    return true;
+  }
+
+ private:
+  // 按键的字母序输出 frame_id 及各类型字段
+  static void appendFields(
+      const TelemetryEvent &event, utils::ByteBuffer &out, bool withGameId) {
+    out.append("\"frame_id\":");
+    appendUint(event.frameId, out);
+    if (withGameId) {
+      out.append(",\"game_id\":");
+      appendUint(event.gameId, out);
+    }
+    switch (event.type) {
+      case EnumEventType::BallPosition:
+        out.append(",\"left\":");
+        appendPoint(event.left, out);
+        out.append(",\"right\":");
+        appendPoint(event.right, out);
+        break;
+      case EnumEventType::PredTrackBallPosition:
+      case EnumEventType::RealTrackBallPosition:
+        out.append(",\"positions\":[");
+        for (size_t i = 0; i < event.positions.size(); ++i) {
+          if (i) out.append(",");
+          appendPoint(event.positions[i], out);
+        }
+        out.append("]");
+        break;
+      case EnumEventType::ShuttlecockPosition:
+        out.append(",\"position\":");
+        appendPoint(event.position, out);
+        break;
+      default:
+        break;
+    }
+    if (event.timestampUs > 0) {
+      out.append(",\"timestamp\":");
+      appendUint(static_cast<uint64_t>(event.timestampUs / 1000), out);
+    }
+  }
+
+  // 缺少字段或类型不符时返回 false，不抛出异常
+  static bool parseFields(const nlohmann::json &msg, TelemetryEvent &event) {
+    if (!msg.is_object()) return false;
+    const nlohmann::json *frameId = field(msg, "frame_id");
+    if (!frameId || !frameId->is_number_unsigned()) return false;
+    event.frameId = frameId->get<uint32_t>();
+    if (const nlohmann::json *timestamp = field(msg, "timestamp")) {
+      if (!timestamp->is_number_unsigned()) return false;
+      event.timestampUs = timestamp->get<int64_t>() * 1000;
+    }
+    switch (event.type) {
+      case EnumEventType::BallPosition:
+        return parsePoint(field(msg, "left"), event.left) &&
+               parsePoint(field(msg, "right"), event.right);
+      case EnumEventType::PredTrackBallPosition:
+      case EnumEventType::RealTrackBallPosition: {
+        const nlohmann::json *positions = field(msg, "positions");
+        if (!positions || !positions->is_array()) return false;
+        event.positions.resize(positions->size());
+        for (size_t i = 0; i < event.positions.size(); ++i) {
+          if (!parsePoint(&(*positions)[i], event.positions[i])) return false;
+        }
+        return true;
+      }
+      case EnumEventType::ShuttlecockPosition:
+        return parsePoint(field(msg, "position"), event.position);
+      default:
+        return true;
+    }
+  }
+
+  // const json 的 operator[] 不能用于不存在的键
+  static const nlohmann::json *field(const nlohmann::json &obj, const char *key) {
+    auto it = obj.find(key);
+    return it == obj.end() ? nullptr : &*it;
+  }
+
+  static bool parsePoint(const nlohmann::json *arr, cv::Point2f &p) {
+    if (!arr || !arr->is_array() || arr->size() != 2) return false;
+    return parseFloat((*arr)[0], p.x) && parseFloat((*arr)[1], p.y);
+  }
+
+  static bool parsePoint(const nlohmann::json *arr, cv::Point3f &p) {
+    if (!arr || !arr->is_array() || arr->size() != 3) return false;
+    return parseFloat((*arr)[0], p.x) && parseFloat((*arr)[1], p.y) &&
+           parseFloat((*arr)[2], p.z);
+  }
+
+  // 非有限值编码为 null，解码为 NaN
+  static bool parseFloat(const nlohmann::json &value, float &out) {
+    if (value.is_null()) {
+      out = std::numeric_limits<float>::quiet_NaN();
+      return true;
+    }
+    if (!value.is_number()) return false;
+    out = value.get<float>();
+    return true;
+  }
+
+  static void appendUint(uint64_t value, utils::ByteBuffer &out) {
+    char buf[24];
+    char *end = buf + sizeof(buf);
+    char *p = end;
+    do {
+      *--p = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value);
+    out.append(p, static_cast<size_t>(end - p));
+  }
+
+  // 与 nlohmann::json::dump 同一算法（Grisu2 最短往返，整数补 ".0"，非有限值为 null），
+  // 直接写入栈上缓冲区
+  static void appendFloat(float value, utils::ByteBuffer &out) {
+    const double v = value;
+    if (!std::isfinite(v)) {
+      out.append("null");
+      return;
+    }
+    char text[64];
+    char *end = nlohmann::detail::to_chars(text, text + sizeof(text), v);
+    out.append(text, static_cast<size_t>(end - text));
+  }
+
+  static void appendPoint(const cv::Point2f &p, utils::ByteBuffer &out) {
+    out.append("[");
+    appendFloat(p.x, out);
+    out.append(",");
+    appendFloat(p.y, out);
+    out.append("]");
+  }
+
+  static void appendPoint(const cv::Point3f &p, utils::ByteBuffer &out) {
+    out.append("[");
+    appendFloat(p.x, out);
+    out.append(",");
+    appendFloat(p.y, out);
+    out.append(",");
+    appendFloat(p.z, out);
+    out.append("]");
+  }
+};
+
+// 二进制遥测消息，所有整数和 float32 均为小端
+//
+// 消息头 8 字节
+//   0  uint32  magic "HKTM"
+//   4  uint8   version
+//   5  uint8   flags，bit0 表示批次
+//   6  uint16  record count
+//
+// 每条记录 12 字节头 + 数据
+//   0  uint8   event (EnumEventType)
+//   1  uint8   reserved
+//   2  uint16  point count，仅轨迹事件
+//   4  uint32  game_id
+//   8  uint32  frame_id
+//
+// 数据
+//   BallPosition          float32 left.x, left.y, right.x, right.y
+//   ShuttlecockPosition   float32 x, y, z
+//   Pred/RealTrack        point count * float32 x, y, z
+class BinaryEventSerializer : public EventSerializer {
+ public:
+  static const uint32_t kMagic = 0x4d544b48;  // "HKTM"
+  static const uint8_t kVersion = 1;
+  static const uint8_t kFlagBatch = 0x01;
+  static const size_t kHeaderSize = 8;
+  static const size_t kRecordHeaderSize = 12;
+  static const size_t kMaxCount = 0xffff;
+
+  void encode(const TelemetryEvent &event, utils::ByteBuffer &out) const override {
+    write(&event, 1, 0, out);
+  }
+
+  void encodeBatch(
+      const TelemetryEvent *events,
+      size_t count,
+      utils::ByteBuffer &out) const override {
+    write(events, count, kFlagBatch, out);
+  }
+
+  bool decode(
+      const unsigned char *message,
+      size_t size,
+      std::vector<TelemetryEvent> &events) const override {
+    events.clear();
+    if (size < kHeaderSize || frame_message::getU32(message) != kMagic) return false;
+    if (message[4] != kVersion) return false;
+
+    size_t count = getU16(message + 6);
+    size_t offset = kHeaderSize;
+    events.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      if (size - offset < kRecordHeaderSize) return false;
+      const unsigned char *p = message + offset;
+      TelemetryEvent &event = events[i];
+      if (p[0] >= kEventTypeCount) return false;
+      event.type = static_cast<EnumEventType>(p[0]);
+      size_t points = getU16(p + 2);
+      event.gameId = frame_message::getU32(p + 4);
+      event.frameId = frame_message::getU32(p + 8);
+      offset += kRecordHeaderSize;
+
+      size_t floats = payloadFloats(event.type, points);
+      if ((size - offset) / 4 < floats) return false;
+      const unsigned char *data = message + offset;
+      switch (event.type) {
+        case EnumEventType::BallPosition:
+          event.left = cv::Point2f(getF32(data), getF32(data + 4));
+          event.right = cv::Point2f(getF32(data + 8), getF32(data + 12));
+          break;
+        case EnumEventType::PredTrackBallPosition:
+        case EnumEventType::RealTrackBallPosition:
+          event.positions.resize(points);
+          for (size_t j = 0; j < points; ++j) {
+            const unsigned char *q = data + j * 12;
+            event.positions[j] = cv::Point3f(getF32(q), getF32(q + 4), getF32(q + 8));
+          }
+          break;
+        case EnumEventType::ShuttlecockPosition:
+          event.position = cv::Point3f(getF32(data), getF32(data + 4), getF32(data + 8));
+          break;
+        default:
+          break;
+      }
+      offset += floats * 4;
+    }
+    return offset == size;
+  }
+
+ private:
+  static size_t payloadFloats(EnumEventType type, size_t points) {
+    switch (type) {
+      case EnumEventType::BallPosition:
+        return 4;
+      case EnumEventType::PredTrackBallPosition:
+      case EnumEventType::RealTrackBallPosition:
+        return points * 3;
+      case EnumEventType::ShuttlecockPosition:
+        return 3;
+      default:
+        return 0;
+    }
+  }
+
+  static void write(
+      const TelemetryEvent *events, size_t count, uint8_t flags, utils::ByteBuffer &out) {
+    if (count > kMaxCount) throw std::length_error("too many telemetry events");
+    size_t size = kHeaderSize;
+    for (size_t i = 0; i < count; ++i) {
+      if (events[i].positions.size() > kMaxCount)
+        throw std::length_error("too many track positions");
+      size += kRecordHeaderSize +
+              payloadFloats(events[i].type, events[i].positions.size()) * 4;
+    }
+
+    unsigned char *p = out.grow(size);
+    frame_message::putU32(p, kMagic);
+    p[4] = kVersion;
+    p[5] = flags;
+    putU16(p + 6, static_cast<uint16_t>(count));
+    p += kHeaderSize;
+
+    for (size_t i = 0; i < count; ++i) {
+      const TelemetryEvent &event = events[i];
+      p[0] = static_cast<unsigned char>(event.type);
+      p[1] = 0;
+      putU16(p + 2, static_cast<uint16_t>(event.positions.size()));
+      frame_message::putU32(p + 4, event.gameId);
+      frame_message::putU32(p + 8, event.frameId);
+      p += kRecordHeaderSize;
+      switch (event.type) {
+        case EnumEventType::BallPosition:
+          p = putF32(p, event.left.x);
+          p = putF32(p, event.left.y);
+          p = putF32(p, event.right.x);
+          p = putF32(p, event.right.y);
+          break;
+        case EnumEventType::PredTrackBallPosition:
+        case EnumEventType::RealTrackBallPosition:
+          for (const auto &pos : event.positions) {
+            p = putF32(p, pos.x);
+            p = putF32(p, pos.y);
+            p = putF32(p, pos.z);
+          }
+          break;
+        case EnumEventType::ShuttlecockPosition:
+          p = putF32(p, event.position.x);
+          p = putF32(p, event.position.y);
+          p = putF32(p, event.position.z);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  static void putU16(unsigned char *p, uint16_t v) {
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+  }
+
+  static uint16_t getU16(const unsigned char *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+  }
+
+  static unsigned char *putF32(unsigned char *p, float v) {
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    frame_message::putU32(p, bits);
+    return p + 4;
+  }
+
+  static float getF32(const unsigned char *p) {
+    uint32_t bits = frame_message::getU32(p);
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+};
+
+inline std::shared_ptr<EventSerializer> createEventSerializer(TelemetryFormat format) {
+  if (format == TelemetryFormat::Binary) return std::make_shared<BinaryEventSerializer>();
+  return std::make_shared<JsonEventSerializer>();
+}
+
+};  // namespace hook_event::event
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+namespace hook_event::event {
+
+// 定义事件类型
+enum EnumEventType {
+  MatchStart = 0,         /// 比赛开始
+  MatchEnd,               /// 比赛结束
+  CameraStream,           /// 摄像头数据流
+  BallPosition,           /// 球位置
+  PredTrackBallPosition,  /// 预测球轨迹
+  RealTrackBallPosition,  /// 实际球轨迹
+  ShuttlecockPosition,    /// 击球点位置
+};
+
+const size_t kEventTypeCount = ShuttlecockPosition + 1;
+
+// 控制事件不允许丢弃
+inline bool isControlEvent(EnumEventType type) {
+  return type == EnumEventType::MatchStart || type == EnumEventType::MatchEnd;
+}
+
+};  // namespace hook_event::event
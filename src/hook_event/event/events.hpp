@@ -0,0 +1,108 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "../utils/object_pool.hpp"
+#include "./event_message.hpp"
+#include "./event_type.hpp"
+
+namespace hook_event::event {
+
+// 强类型事件
+// 通过 EventManager::emit<Event>(args...) 触发，参数按字段顺序构造事件，
+// 事件类型与回调在编译期由 EventTraits 确定，参数不匹配时无法编译。
+
+// 轨迹点缓冲区，由 EventManager::acquireTrackPoints 从池中取得，
+// 在线程间传递时只增减引用计数，不拷贝点数据
+typedef utils::ObjectPool<std::vector<cv::Point3f>> TrackPointPool;
+typedef TrackPointPool::Ref TrackPoints;
+
+struct MatchStartEvent {};
+
+struct MatchEndEvent {};
+
+struct CameraStreamEvent {
+  cv::Mat leftFrame;
+  cv::Mat rightFrame;
+};
+
+struct BallPositionEvent {
+  cv::Point2f leftPos;
+  cv::Point2f rightPos;
+};
+
+struct PredTrackBallPositionEvent {
+  TrackPoints positions;
+};
+
+struct RealTrackBallPositionEvent {
+  TrackPoints positions;
+};
+
+struct ShuttlecockPositionEvent {
+  cv::Point3f position;
+};
+
+// kType 为对应的 EnumEventType，dispatch 调用对应的 EventMessage 回调
+// 未特化的类型没有定义，作为事件使用时编译失败
+template <typename Event>
+struct EventTraits;
+
+template <>
+struct EventTraits<MatchStartEvent> {
+  static constexpr EnumEventType kType = EnumEventType::MatchStart;
+  static void dispatch(EventMessage &cb, const MatchStartEvent &) {
+    cb.matchStartCallback();
+  }
+};
+
+template <>
+struct EventTraits<MatchEndEvent> {
+  static constexpr EnumEventType kType = EnumEventType::MatchEnd;
+  static void dispatch(EventMessage &cb, const MatchEndEvent &) {
+    cb.matchEndCallback();
+  }
+};
+
+template <>
+struct EventTraits<CameraStreamEvent> {
+  static constexpr EnumEventType kType = EnumEventType::CameraStream;
+  static void dispatch(EventMessage &cb, const CameraStreamEvent &event) {
+    cb.cameraStreamCallback(event.leftFrame, event.rightFrame);
+  }
+};
+
+template <>
+struct EventTraits<BallPositionEvent> {
+  static constexpr EnumEventType kType = EnumEventType::BallPosition;
+  static void dispatch(EventMessage &cb, const BallPositionEvent &event) {
+    cb.ballPositionCallback(event.leftPos, event.rightPos);
+  }
+};
+
+template <>
+struct EventTraits<PredTrackBallPositionEvent> {
+  static constexpr EnumEventType kType = EnumEventType::PredTrackBallPosition;
+  static void dispatch(EventMessage &cb, const PredTrackBallPositionEvent &event) {
+    cb.predTrackBallPositionCallback(*event.positions);
+  }
+};
+
+template <>
+struct EventTraits<RealTrackBallPositionEvent> {
+  static constexpr EnumEventType kType = EnumEventType::RealTrackBallPosition;
+  static void dispatch(EventMessage &cb, const RealTrackBallPositionEvent &event) {
+    cb.realTrackBallPositionCallback(*event.positions);
+  }
+};
+
+template <>
+struct EventTraits<ShuttlecockPositionEvent> {
+  static constexpr EnumEventType kType = EnumEventType::ShuttlecockPosition;
+  static void dispatch(EventMessage &cb, const ShuttlecockPositionEvent &event) {
+    cb.shuttlecockPositionCallback(event.position);
+  }
+};
+
+};  // namespace hook_event::event
@@ -0,0 +1,248 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <opencv2/opencv.hpp>
+#include <stdexcept>
+#include <vector>
+
+#include "./frame_message.hpp"
+#include "./image_codec.hpp"
+
+namespace hook_event::event {
+
+// 图像增量编码
+// 摄像头固定时相邻帧只有运动区域变化。每隔 keyframeInterval 帧或场景切换时发送完整关键帧，
+// 其余帧只发送相对前一帧变化的分块：变化分块按列拼接为一张图像后 PNG 压缩。
+//
+// 增量帧数据（codec 为 PngDelta），整数均为小端
+//   0  uint16  tile size
+//   2  uint16  reserved
+//   4  uint32  tile count
+//   8  tile count 个 (uint16 x, uint16 y) 分块坐标，单位为分块
+//   之后为拼接图像的 PNG，宽为 tile size，高为 tile size * tile count，
+//   边缘不足一块的分块左上对齐
+struct FrameDeltaConfig {
+  // 关键帧间隔（帧数），0 表示关闭增量编码
+  uint32_t keyframeInterval = 0;
+  // 分块边长，单位像素，取值 [1, 65535]
+  int tileSize = 32;
+  // 8 位图像各通道差值不超过该值视为未变化，0 为无损
+  int threshold = 0;
+  // 变化分块占比超过该值视为场景切换，发送关键帧
+  double sceneChangeRatio = 0.5;
+};
+
+// 一路图像的增量编码结果，PNG 压缩在编码线程中完成
+struct FrameDelta {
+  bool keyframe = true;
+  uint32_t baseFrameId = 0;  // 增量帧所基于的前一帧
+  // 关键帧为整帧，增量帧为变化分块的拼接图像
+  cv::Mat image;
+  // 增量帧变化分块坐标，x, y 交替
+  std::vector<uint16_t> tiles;
+};
+
+namespace frame_delta {
+
+const size_t kHeaderSize = 8;
+// 分块边长和分块坐标均为 uint16
+const int kMaxTileSize = 65535;
+const int kMaxTiles = 65536;
+
+inline size_t headerSize(const FrameDelta &delta) {
+  return kHeaderSize + delta.tiles.size() * 2;
+}
+
+// 写入增量帧头部及分块坐标，out 至少 headerSize 字节
+inline void writeHeader(const FrameDelta &delta, int tileSize, unsigned char *out) {
+  out[0] = static_cast<unsigned char>(tileSize);
+  out[1] = static_cast<unsigned char>(tileSize >> 8);
+  out[2] = 0;
+  out[3] = 0;
+  frame_message::putU32(out + 4, static_cast<uint32_t>(delta.tiles.size() / 2));
+  unsigned char *p = out + kHeaderSize;
+  for (uint16_t v : delta.tiles) {
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+    p += 2;
+  }
+}
+
+};  // namespace frame_delta
+
+// 增量编码器，每路摄像头一个，按帧顺序调用
+// 参考帧即解码端重建的图像，只更新已发送的分块，有损阈值下误差不会累积超过 threshold
+class FrameDeltaEncoder {
+ public:
+  FrameDeltaEncoder() = default;
+
+  explicit FrameDeltaEncoder(const FrameDeltaConfig &config) : config_(config) {
+    if (config.tileSize <= 0 || config.tileSize > frame_delta::kMaxTileSize)
+      throw std::runtime_error("delta tile size must be in [1, 65535]");
+  }
+
+  bool enabled() const {
+    return config_.keyframeInterval > 0;
+  }
+
+  int tileSize() const {
+    return config_.tileSize;
+  }
+
+  // 下一帧强制为关键帧
+  void reset() {
+    reference_.release();
+  }
+
+  void next(const cv::Mat &frame, uint32_t frameId, FrameDelta &delta) {
+    const int tile = config_.tileSize;
+    const int tilesX = static_cast<int>((int64_t(frame.cols) + tile - 1) / tile);
+    const int tilesY = static_cast<int>((int64_t(frame.rows) + tile - 1) / tile);
+    delta.tiles.clear();
+    delta.baseFrameId = frameId_;
+    // 分块坐标超出 uint16 时只能发送关键帧
+    delta.keyframe = reference_.empty() || frame.rows != reference_.rows ||
+                     frame.cols != reference_.cols || frame.type() != reference_.type() ||
+                     sinceKeyframe_ + 1 >= config_.keyframeInterval ||
+                     tilesX > frame_delta::kMaxTiles || tilesY > frame_delta::kMaxTiles;
+    frameId_ = frameId;
+
+    if (!delta.keyframe) {
+      for (int ty = 0; ty < tilesY; ++ty) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+          if (!changed(frame, tileRect(frame, tx, ty))) continue;
+          delta.tiles.push_back(static_cast<uint16_t>(tx));
+          delta.tiles.push_back(static_cast<uint16_t>(ty));
+        }
+      }
+      size_t total = static_cast<size_t>(tilesX) * static_cast<size_t>(tilesY);
+      size_t count = delta.tiles.size() / 2;
+      // 拼接图像的高度须在 int 范围内
+      delta.keyframe = count > config_.sceneChangeRatio * total ||
+                       count > static_cast<size_t>(INT_MAX / tile);
+    }
+
+    if (delta.keyframe) {
+      delta.tiles.clear();
+      delta.image = frame;
+      frame.copyTo(reference_);
+      sinceKeyframe_ = 0;
+      return;
+    }
+
+    // 变化分块拼接为一列，同时写回参考帧
+    size_t count = delta.tiles.size() / 2;
+    delta.image.create(static_cast<int>(count) * tile, tile, frame.type());
+    for (size_t i = 0; i < count; ++i) {
+      cv::Rect rect = tileRect(frame, delta.tiles[i * 2], delta.tiles[i * 2 + 1]);
+      cv::Mat dst = delta.image(cv::Rect(0, static_cast<int>(i) * tile, tile, tile));
+      if (rect.width != tile || rect.height != tile) dst.setTo(cv::Scalar::all(0));
+      cv::Mat src = frame(rect);
+      cv::Mat ref = reference_(rect);
+      cv::Mat part = dst(cv::Rect(0, 0, rect.width, rect.height));
+      src.copyTo(part);
+      src.copyTo(ref);
+    }
+    ++sinceKeyframe_;
+  }
+
+ private:
+  cv::Rect tileRect(const cv::Mat &frame, int tx, int ty) const {
+    const int tile = config_.tileSize;
+    int x = tx * tile;
+    int y = ty * tile;
+    return cv::Rect(x, y, std::min(tile, frame.cols - x), std::min(tile, frame.rows - y));
+  }
+
+  bool changed(const cv::Mat &frame, const cv::Rect &rect) const {
+    size_t bytes = static_cast<size_t>(rect.width) * frame.elemSize();
+    size_t offset = static_cast<size_t>(rect.x) * frame.elemSize();
+    bool lossless = config_.threshold <= 0 || frame.depth() != CV_8U;
+    for (int y = rect.y; y < rect.y + rect.height; ++y) {
+      const unsigned char *a = frame.ptr(y) + offset;
+      const unsigned char *b = reference_.ptr(y) + offset;
+      if (lossless) {
+        if (std::memcmp(a, b, bytes) != 0) return true;
+        continue;
+      }
+      for (size_t i = 0; i < bytes; ++i) {
+        if (std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])) > config_.threshold)
+          return true;
+      }
+    }
+    return false;
+  }
+
+  FrameDeltaConfig config_;
+  cv::Mat reference_;
+  uint32_t frameId_ = 0;
+  uint32_t sinceKeyframe_ = 0;
+};
+
+// 参考解码器，每路摄像头一个，按帧顺序调用
+class FrameDeltaDecoder {
+ public:
+  // 非增量帧按 decodeImage 解码并作为新的参考帧。
+  // 返回的 frame 与解码器共享内存，下一次 decode 前有效；
+  // 增量帧的前一帧缺失时返回 false，需等待下一个关键帧
+  bool decode(const frame_message::FramePart &part, cv::Mat &frame) {
+    if (part.codec != ImageCodec::PngDelta) {
+      reference_ = decodeImage(part);
+      valid_ = !reference_.empty();
+      frameId_ = part.frameId;
+      frame = reference_;
+      return valid_;
+    }
+    const unsigned char *data = part.data;
+    size_t size = part.size;
+    if (!valid_ || part.baseFrameId != frameId_ || size < frame_delta::kHeaderSize)
+      return fail();
+
+    int tile = data[0] | (data[1] << 8);
+    size_t count = frame_message::getU32(data + 4);
+    size_t header = frame_delta::kHeaderSize + count * 4;
+    if (tile <= 0 || header > size) return fail();
+    cv::Mat tiles;
+    if (count) {
+      cv::Mat png(
+          1,
+          static_cast<int>(size - header),
+          CV_8UC1,
+          const_cast<unsigned char *>(data + header));
+      tiles = cv::imdecode(png, cv::IMREAD_UNCHANGED);
+      if (tiles.empty() || tiles.type() != reference_.type() || tiles.cols != tile ||
+          static_cast<size_t>(tiles.rows) != count * tile)
+        return fail();
+    }
+
+    const unsigned char *p = data + frame_delta::kHeaderSize;
+    for (size_t i = 0; i < count; ++i, p += 4) {
+      int x = (p[0] | (p[1] << 8)) * tile;
+      int y = (p[2] | (p[3] << 8)) * tile;
+      if (x >= reference_.cols || y >= reference_.rows) return fail();
+      cv::Rect rect(
+          x, y, std::min(tile, reference_.cols - x), std::min(tile, reference_.rows - y));
+      cv::Mat ref = reference_(rect);
+      tiles(cv::Rect(0, static_cast<int>(i) * tile, rect.width, rect.height)).copyTo(ref);
+    }
+    frameId_ = part.frameId;
+    frame = reference_;
+    return true;
+  }
+
+ private:
+  bool fail() {
+    valid_ = false;
+    return false;
+  }
+
+  cv::Mat reference_;
+  uint32_t frameId_ = 0;
+  bool valid_ = false;
+};
+
+};  // namespace hook_event::event
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace hook_event::event {
+
+// 图像消息格式
+enum class ImageWireFormat {
+  Json = 0,      /// {"event","game_id","frame_id","data": base64(png)}
+  Binary,        /// 二进制，每路一条消息
+  BinaryStereo,  /// 二进制，左右两路合并为一条消息
+};
+
+// 摄像头
+enum class CameraSide : uint8_t {
+  Left = 0,
+  Right = 1,
+};
+
+// 图像编码
+enum class ImageCodec : uint8_t {
+  Png = 0,
+  PngDelta = 1,  /// 相对前一帧的变化分块，见 frame_delta.hpp
+  Jpeg = 2,
+  Webp = 3,
+  Raw = 4,      /// 原始像素，按 rows、cols、type 解释
+  RawLz4 = 5,   /// LZ4 压缩的原始像素
+  RawZstd = 6,  /// zstd 压缩的原始像素
+};
+
+// 二进制图像消息，所有整数均为小端
+//
+// 消息头 8 字节
+//   0  uint32  magic "HKFM"
+//   4  uint8   version
+//   5  uint8   part count
+//   6  uint16  reserved
+//
+// 每个分片 32 字节头 + 数据
+//   0  uint8   event (EnumEventType)
+//   1  uint8   camera side
+//   2  uint8   codec
+//   3  uint8   flags
+//   4  uint32  game_id
+//   8  uint32  frame_id
+//   12 uint32  rows，编码图像（缩放后）的尺寸
+//   16 uint32  cols
+//   20 int32   cv type
+//   24 uint32  payload size
+//   28 uint32  base frame_id，增量帧所基于的前一帧，其他编码为 0
+namespace frame_message {
+
+const uint32_t kMagic = 0x4d464b48;  // "HKFM"
+const uint8_t kVersion = 1;
+const size_t kHeaderSize = 8;
+const size_t kPartHeaderSize = 32;
+
+struct FramePart {
+  uint8_t event = 0;
+  CameraSide side = CameraSide::Left;
+  ImageCodec codec = ImageCodec::Png;
+  uint8_t flags = 0;
+  uint32_t gameId = 0;
+  uint32_t frameId = 0;
+  uint32_t rows = 0;
+  uint32_t cols = 0;
+  int32_t type = 0;
+  uint32_t baseFrameId = 0;
+  // 解码时指向原消息内存，编码时指向待写入数据
+  const unsigned char *data = nullptr;
+  uint32_t size = 0;
+};
+
+inline void putU32(unsigned char *p, uint32_t v) {
+  p[0] = static_cast<unsigned char>(v);
+  p[1] = static_cast<unsigned char>(v >> 8);
+  p[2] = static_cast<unsigned char>(v >> 16);
+  p[3] = static_cast<unsigned char>(v >> 24);
+}
+
+inline uint32_t getU32(const unsigned char *p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline size_t encodedSize(const FramePart *parts, size_t count) {
+  size_t size = kHeaderSize;
+  for (size_t i = 0; i < count; ++i) size += kPartHeaderSize + parts[i].size;
+  return size;
+}
+
+// out 至少 encodedSize 字节，返回写入长度
+inline size_t encode(const FramePart *parts, size_t count, unsigned char *out) {
+  unsigned char *p = out;
+  putU32(p, kMagic);
+  p[4] = kVersion;
+  p[5] = static_cast<unsigned char>(count);
+  p[6] = 0;
+  p[7] = 0;
+  p += kHeaderSize;
+
+  for (size_t i = 0; i < count; ++i) {
+    const FramePart &part = parts[i];
+    p[0] = part.event;
+    p[1] = static_cast<unsigned char>(part.side);
+    p[2] = static_cast<unsigned char>(part.codec);
+    p[3] = part.flags;
+    putU32(p + 4, part.gameId);
+    putU32(p + 8, part.frameId);
+    putU32(p + 12, part.rows);
+    putU32(p + 16, part.cols);
+    putU32(p + 20, static_cast<uint32_t>(part.type));
+    putU32(p + 24, part.size);
+    putU32(p + 28, part.baseFrameId);
+    p += kPartHeaderSize;
+    if (part.size) std::memcpy(p, part.data, part.size);
+    p += part.size;
+  }
+  return static_cast<size_t>(p - out);
+}
+
+// 写入 out 末尾
+inline void encode(const FramePart *parts, size_t count, std::string &out) {
+  size_t offset = out.size();
+  out.resize(offset + encodedSize(parts, count));
+  encode(parts, count, reinterpret_cast<unsigned char *>(&out[offset]));
+}
+
+// 解析消息，parts 中的 data 指向 message 内存
+inline bool decode(
+    const unsigned char *message, size_t size, std::vector<FramePart> &parts) {
+  parts.clear();
+  if (size < kHeaderSize || getU32(message) != kMagic) return false;
+  if (message[4] != kVersion) return false;
+
+  size_t count = message[5];
+  size_t offset = kHeaderSize;
+  for (size_t i = 0; i < count; ++i) {
+    if (size - offset < kPartHeaderSize) return false;
+    const unsigned char *p = message + offset;
+    FramePart part;
+    part.event = p[0];
+    part.side = static_cast<CameraSide>(p[1]);
+    part.codec = static_cast<ImageCodec>(p[2]);
+    part.flags = p[3];
+    part.gameId = getU32(p + 4);
+    part.frameId = getU32(p + 8);
+    part.rows = getU32(p + 12);
+    part.cols = getU32(p + 16);
+    part.type = static_cast<int32_t>(getU32(p + 20));
+    part.size = getU32(p + 24);
+    part.baseFrameId = getU32(p + 28);
+    offset += kPartHeaderSize;
+    if (size - offset < part.size) return false;
+    part.data = message + offset;
+    offset += part.size;
+    parts.push_back(part);
+  }
+  return offset == size;
+}
+
+};  // namespace frame_message
+
+};  // namespace hook_event::event
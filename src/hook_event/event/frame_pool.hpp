@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <vector>
+
+namespace hook_event::event {
+
+struct FramePoolConfig {
+  // 槽位数，0 表示不使用帧池；每个槽位为一对左右图像
+  size_t slots = 0;
+  // 图像尺寸及类型，与摄像头输出一致
+  int rows = 0;
+  int cols = 0;
+  int type = CV_8UC3;
+};
+
+// 帧池中的一对图像，写入后通过 EventManager::emit(FrameSlot) 发送
+struct FrameSlot {
+  cv::Mat left;
+  cv::Mat right;
+
+  explicit operator bool() const {
+    return !left.empty();
+  }
+};
+
+// 预分配的双目图像池
+// 槽位图像的最后一个 cv::Mat 引用（包括回调、编码任务中保留的拷贝）释放后自动归还，
+// 不需要显式归还，稳定状态下不分配图像内存。槽位全部占用时 acquire 等待，
+// 帧池大小即为采集线程与下游之间可同时存在的帧数。
+// 写入时须保持尺寸和类型不变（如 copyTo、cap.read 到 slot.left），否则 OpenCV 会重新分配。
+class FramePool {
+ public:
+  explicit FramePool(const FramePoolConfig &config) : next_(0) {
+    for (size_t i = 0; i < config.slots; ++i) {
+      FrameSlot slot;
+      slot.left.create(config.rows, config.cols, config.type);
+      slot.right.create(config.rows, config.cols, config.type);
+      slots_.push_back(slot);
+    }
+  }
+
+  size_t size() const {
+    return slots_.size();
+  }
+
+  // 取得空闲槽位，全部占用时等待至多 timeoutMs 毫秒（小于 0 时一直等待），超时返回空槽位
+  FrameSlot acquire(int timeoutMs = -1) {
+    auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    // 归还没有通知，按逐渐加长的间隔重试
+    int sleepUs = 50;
+    while (true) {
+      FrameSlot slot = tryAcquire();
+      if (slot || slots_.empty()) return slot;
+      if (timeoutMs >= 0 && std::chrono::steady_clock::now() >= deadline) return slot;
+      std::this_thread::sleep_for(std::chrono::microseconds(sleepUs));
+      sleepUs = std::min(sleepUs * 2, 1000);
+    }
+  }
+
+  // 取得空闲槽位，全部占用时返回空槽位
+  FrameSlot tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t n = 0; n < slots_.size(); ++n) {
+      FrameSlot &slot = slots_[next_];
+      next_ = (next_ + 1) % slots_.size();
+      if (idle(slot.left) && idle(slot.right)) return slot;
+    }
+    return FrameSlot();
+  }
+
+  // 空闲槽位数
+  size_t available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto &slot : slots_) count += idle(slot.left) && idle(slot.right);
+    return count;
+  }
+
+ private:
+  // 只有池本身持有引用
+  static bool idle(const cv::Mat &image) {
+    return image.u && CV_XADD(&image.u->refcount, 0) == 1;
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<FrameSlot> slots_;
+  size_t next_;
+};
+
+};  // namespace hook_event::event
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+
+namespace hook_event::event {
+
+struct FrameSamplingConfig {
+  // 默认关闭，所有帧全帧率发送
+  bool enabled = false;
+  // 最近一次球位置、轨迹或击球点事件后保持全帧率的时间，毫秒
+  int activeHoldMs = 2000;
+  // 空闲时的帧率，0 表示空闲时不发送
+  double idleFps = 1.0;
+  // 空闲时缓存的最近帧数，回合开始时先于当前帧发送，避免丢失回合开始的画面。
+  // 缓存的帧保留图像引用，使用帧池时须小于槽位数
+  size_t preRollFrames = 15;
+};
+
+// 采样统计，单位为双目帧
+struct FrameSamplingStats {
+  uint64_t active = 0;   /// 回合中发送的帧数
+  uint64_t idle = 0;     /// 空闲时按 idleFps 发送的帧数
+  uint64_t preRoll = 0;  /// 回合开始时补发的缓存帧数
+  uint64_t dropped = 0;  /// 未发送的帧数
+};
+
+// 按球的活动情况决定图像是否发送，时间均为事件的采集（emit）时刻
+// activity 可在任意线程调用（遥测回调），sample 只在图像回调线程中调用。
+// 遥测可能先于更早采集的图像分发，因此采集时间与最近活动相差不超过 activeHoldMs
+// 的帧（含活动之前的帧）均视为回合中
+class FrameSampler {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  enum class Action {
+    Active,  /// 回合中，发送（先发送缓存帧）
+    Idle,    /// 空闲采样帧，发送并丢弃缓存帧
+    Hold,    /// 不发送，放入缓存
+  };
+
+  explicit FrameSampler(const FrameSamplingConfig &config)
+      : hold_(std::chrono::milliseconds(config.activeHoldMs)),
+        idle_interval_(
+            config.idleFps > 0
+                ? std::chrono::duration_cast<Clock::duration>(
+                      std::chrono::duration<double>(1.0 / config.idleFps))
+                : Clock::duration::zero()),
+        last_activity_(kNever) {}
+
+  // 遥测事件表明球在场上，乱序到达时保留较晚的时刻
+  void activity(Clock::time_point captured) {
+    int64_t value = ticks(captured);
+    int64_t current = last_activity_.load(std::memory_order_relaxed);
+    while (value > current &&
+           !last_activity_.compare_exchange_weak(
+               current, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  Action sample(Clock::time_point captured) {
+    int64_t last = last_activity_.load(std::memory_order_relaxed);
+    if (last != kNever && std::abs(ticks(captured) - last) <= hold_.count())
+      return Action::Active;
+    if (idle_interval_ > Clock::duration::zero() &&
+        (!idle_sampled_ || captured - last_idle_ >= idle_interval_)) {
+      idle_sampled_ = true;
+      last_idle_ = captured;
+      return Action::Idle;
+    }
+    return Action::Hold;
+  }
+
+ private:
+  static const int64_t kNever = INT64_MIN;
+
+  static int64_t ticks(Clock::time_point t) {
+    return std::chrono::duration_cast<Clock::duration>(t.time_since_epoch()).count();
+  }
+
+  const Clock::duration hold_;
+  const Clock::duration idle_interval_;
+  std::atomic<int64_t> last_activity_;
+  bool idle_sampled_ = false;
+  Clock::time_point last_idle_;
+};
+
+};  // namespace hook_event::event
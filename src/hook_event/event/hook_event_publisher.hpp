@@ -1,6 +1,9 @@
 #pragma once
 
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <opencv2/opencv.hpp>
 #include <string>
@@ -8,105 +11,548 @@
 
 #include "../publisher/base_publisher.hpp"
 #include "../utils/base64.hpp"
+#include "../utils/buffer_pool.hpp"
+#include "../utils/ordered_task_pool.hpp"
 #include "./base_event.hpp"
+#include "./batch_controller.hpp"
+#include "./event_clock.hpp"
+#include "./event_serializer.hpp"
+#include "./frame_delta.hpp"
+#include "./frame_message.hpp"
+#include "./frame_sampler.hpp"
+#include "./image_codec.hpp"
+#include "./pipeline_metrics.hpp"
+#include "./telemetry_batcher.hpp"
 
 namespace hook_event::event {
 
+struct HookEventPublisherConfig {
+  // 图像编码线程数，0 表示在事件线程中同步编码
+  size_t encodeThreads = 0;
+  // 同时处于编码/推送中的最大帧数，超出时 cameraStreamCallback 阻塞
+  size_t maxFramesInFlight = 4;
+  // topic_image 的消息格式，默认保持 JSON 兼容
+  ImageWireFormat imageFormat = ImageWireFormat::Json;
+  // 图像编码、质量及缩放，默认为 OpenCV 默认等级的 PNG
+  ImageEncodeConfig image;
+  // 图像增量编码，默认关闭；开启时固定使用无损 PNG（等级取 image.level），不缩放
+  FrameDeltaConfig delta;
+  // 按球的活动情况采样图像，回合之间降低帧率，默认关闭
+  FrameSamplingConfig sampling;
+  // 球位置、轨迹等遥测事件每批最多条数，1 表示逐条推送
+  size_t telemetryBatchSize = 1;
+  // 遥测批次最长等待时间，0 表示只按条数合并
+  int telemetryBatchMs = 50;
+  // 按发布延迟自动调整遥测批次，开启时以上两项作为初始值（限制在其范围内）
+  AdaptiveBatchConfig adaptiveBatch;
+  // topic 的消息格式，默认保持 JSON 兼容
+  TelemetryFormat telemetryFormat = TelemetryFormat::Json;
+  // 自定义序列化，非空时忽略 telemetryFormat
+  std::shared_ptr<EventSerializer> serializer;
+  // 非空时记录编码、序列化、发布各阶段耗时
+  std::shared_ptr<PipelineMetrics> metrics;
+  // 记录事件采集（emit）时间：JSON 消息带 timestamp 字段（Unix 毫秒），Kafka 消息时间戳
+  // 取采集时间，并带事件名、采集时间、发布时间消息头，供 latency_probe 统计端到端延迟
+  bool timestamps = true;
+};
+
 class HookEventPublisher : public EventMessage {
  public:
   HookEventPublisher(
       std::shared_ptr<publisher::BasePublisher> publisher,
       const std::string topic = "test",
-      const std::string topic_image = "test_image")
-      : game_id_(0),
+      const std::string topic_image = "test_image",
+      const HookEventPublisherConfig config = HookEventPublisherConfig())
+      : topic_(topic),
+        topic_image_(topic_image),
+        game_id_(0),
         frame_id_(0),
         publisher_(publisher),
-        topic_(topic),
-        topic_image_(topic_image) {}
+        config_(config),
+        buffer_pool_(config.maxFramesInFlight * 2 + 2),
+        // 左右两路各占一个任务
+        encode_pool_(config.encodeThreads, config.maxFramesInFlight * 2),
+        image_encoder_(
+            config.delta.keyframeInterval > 0 ? deltaImageConfig(config.image)
+                                              : config.image),
+        delta_{FrameDeltaEncoder(config.delta), FrameDeltaEncoder(config.delta)},
+        sampler_(config.sampling),
+        serializer_(
+            config.serializer ? config.serializer
+                              : createEventSerializer(config.telemetryFormat)),
+        telemetry_pool_(64, 1 << 20),
+        batching_(config.telemetryBatchSize > 1 || config.adaptiveBatch.enabled),
+        batch_controller_(config.adaptiveBatch, initialLimits(config)),
+        telemetry_(
+            initialLimits(config).items,
+            initialLimits(config).delayMs,
+            [this](const TelemetryEvent *events, size_t count) {
+              publishBatch(events, count);
+            }) {
+    if (config.adaptiveBatch.enabled)
+      batch_thread_ = std::thread([this] { adjustBatches(); });
+  }
+
+  ~HookEventPublisher() {
+    {
+      std::lock_guard<std::mutex> lock(batch_mutex_);
+      batch_stopping_ = true;
+    }
+    batch_cv_.notify_one();
+    if (batch_thread_.joinable()) batch_thread_.join();
+    encode_pool_.flush();
+  }
 
   void matchStartCallback() override {
-    nlohmann::json msg = {
-        {"event", "match_start"},
-        {"game_id", ++game_id_},
-        {"frame_id", 0},
-    };
+    TelemetryEvent event;
+    event.type = EnumEventType::MatchStart;
+    event.gameId = ++game_id_;
+    event.timestampUs = captureTimeUs();
     frame_id_.store(0);
-    publisher_->publish(topic_, msg.dump());
+    dropPreRoll();
+    // 每场比赛从关键帧开始
+    delta_[0].reset();
+    delta_[1].reset();
+    publishEvent(event);
   }
 
   void matchEndCallback() override {
-    nlohmann::json msg = {
-        {"event", "match_end"},
-        {"game_id", game_id_.load()},
-        {"frame_id", frame_id_.load()},
-    };
-    publisher_->publish(topic_, msg.dump());
+    // 保证本场比赛的图像和遥测数据先于 match_end 推送，缓存的空闲帧不再发送
+    dropPreRoll();
+    encode_pool_.flush();
+    telemetry_.flush();
+    TelemetryEvent event;
+    event.type = EnumEventType::MatchEnd;
+    event.gameId = game_id_.load();
+    event.frameId = frame_id_.load();
+    event.timestampUs = captureTimeUs();
+    publishEvent(event);
   }
 
+  // 每一帧都占用 frame_id，采样未发送的帧在图像主题中表现为 frame_id 的间隔，
+  // 遥测事件的 frame_id 仍对应摄像头帧
   void cameraStreamCallback(
       const cv::Mat &leftFrame, const cv::Mat &rightFrame) override {
-    uint32_t frame_id_pre = ++frame_id_;
-
-    auto encode_and_send = [this, frame_id_pre](
-                               const cv::Mat &frame, const std::string &event_name) {
-      std::vector<unsigned char> buf;
-      cv::imencode(".png", frame, buf);
-      size_t outlen = 4 * ((buf.size() + 2) / 3);
-      std::string encoded = encode_base64(buf);
-      assert(!encoded.empty());
-
-      // 推送内容
-      nlohmann::json msg = {
-          {"event", event_name},
-          {"game_id", game_id_.load()},
-          {"frame_id", frame_id_pre},
-          {"data", encoded},
-      };
-      publisher_->publish(topic_image_, msg.dump());
-    };
-    encode_and_send(leftFrame, "camera_stream_left");
-    encode_and_send(rightFrame, "camera_stream_right");
+    uint32_t frameId = ++frame_id_;
+    int64_t capturedUs = captureTimeUs();
+    if (config_.sampling.enabled &&
+        !sampleFrame(leftFrame, rightFrame, frameId, capturedUs))
+      return;
+    publishFrame(leftFrame, rightFrame, frameId, capturedUs);
+  }
+
+  // 等待所有图像编码并推送完成，并推送缓存的遥测数据
+  void flush() {
+    encode_pool_.flush();
+    telemetry_.flush();
+  }
+
+  FrameSamplingStats frameSamplingStats() const {
+    FrameSamplingStats stats;
+    stats.active = frames_active_.load();
+    stats.idle = frames_idle_.load();
+    stats.preRoll = frames_pre_roll_.load();
+    stats.dropped = frames_dropped_.load();
+    return stats;
   }
 
   void ballPositionCallback(
       const cv::Point2f &leftPos, const cv::Point2f &rightPos) override {
-    nlohmann::json msg = {
-        {"event", "ball_position"},
-        {"game_id", game_id_.load()},
-        {"frame_id", frame_id_.load()},
-        {"left", {leftPos.x, leftPos.y}},
-        {"right", {rightPos.x, rightPos.y}},
+    markActivity();
+    uint32_t frameId = frame_id_.load();
+    int64_t captured = captureTimeUs();
+    auto fill = [&](TelemetryEvent &event) {
+      event.frameId = frameId;
+      event.timestampUs = captured;
+      event.left = leftPos;
+      event.right = rightPos;
     };
-    publisher_->publish(topic_, msg.dump());
-  }
-
-  // void predTrackBallPositionCallback(const std::vector<cv::Point3f>
-  // &pos) override
-  // {
-  //     nlohmann::json arr;
-  //     for (const auto &p : pos)
-  //         arr.push_back({p.x, p.y, p.z});
-  //     nlohmann::json msg = {{"event", "pred_track_ball_position"},
-  //     {"positions", arr}}; publisher_->publish(topic_, msg.dump());
-  // }
-
-  // void realTrackBallPositionCallback(const std::vector<cv::Point3f>
-  // &pos) override
-  // {
-  //     nlohmann::json arr;
-  //     for (const auto &p : pos)
-  //         arr.push_back({p.x, p.y, p.z});
-  //     nlohmann::json msg = {{"event", "real_track_ball_position"},
-  //     {"positions", arr}}; publisher_->publish(topic_, msg.dump());
-  // }
-
-  // void shuttlecockPositionCallback(const cv::Point3f &pos) override
-  // {
-  //     nlohmann::json msg = {
-  //         {"event", "shuttlecock_position"},
-  //         {"position", {pos.x, pos.y, pos.z}}};
-  //     publisher_->publish(topic_, msg.dump());
-  // }
+    if (batching_) {
+      telemetry_.add(EnumEventType::BallPosition, game_id_.load(), fill);
+      return;
+    }
+    TelemetryEvent event;
+    event.type = EnumEventType::BallPosition;
+    event.gameId = game_id_.load();
+    fill(event);
+    publishEvent(event);
+  }
+
+  void predTrackBallPositionCallback(const std::vector<cv::Point3f> &pos) override {
+    publishTrack(EnumEventType::PredTrackBallPosition, pos);
+  }
+
+  void realTrackBallPositionCallback(const std::vector<cv::Point3f> &pos) override {
+    publishTrack(EnumEventType::RealTrackBallPosition, pos);
+  }
+
+  // 击球点为离散事件，不参与合并
+  void shuttlecockPositionCallback(const cv::Point3f &pos) override {
+    markActivity();
+    TelemetryEvent event;
+    event.type = EnumEventType::ShuttlecockPosition;
+    event.gameId = game_id_.load();
+    event.frameId = frame_id_.load();
+    event.position = pos;
+    event.timestampUs = captureTimeUs();
+    publishEvent(event);
+  }
+
+ private:
+  // 一帧双目图像的编码结果
+  struct StereoFrame {
+    uint32_t gameId = 0;
+    uint32_t frameId = 0;
+    int64_t capturedUs = 0;
+    frame_message::FramePart parts[2];
+    std::vector<unsigned char> encoded[2];
+    utils::PooledBuffer message[2];
+    FrameDelta delta[2];
+  };
+
+  // 空闲时缓存的未发送帧
+  struct HeldFrame {
+    cv::Mat left;
+    cv::Mat right;
+    uint32_t frameId = 0;
+    int64_t capturedUs = 0;
+  };
+
+  void publishFrame(
+      const cv::Mat &leftFrame,
+      const cv::Mat &rightFrame,
+      uint32_t frameId,
+      int64_t capturedUs) {
+    auto stereo = std::make_shared<StereoFrame>();
+    stereo->gameId = game_id_.load();
+    stereo->frameId = frameId;
+    stereo->capturedUs = capturedUs;
+
+    // 与前一帧比较须按帧顺序进行，压缩仍在编码线程中
+    if (delta_[0].enabled()) {
+      delta_[0].next(leftFrame, frameId, stereo->delta[0]);
+      delta_[1].next(rightFrame, frameId, stereo->delta[1]);
+    }
+
+    // 左右两路并行编码，按 左、右 的顺序推送
+    submitFrame(stereo, leftFrame, CameraSide::Left);
+    submitFrame(stereo, rightFrame, CameraSide::Right);
+  }
+
+  // 返回当前帧是否发送。回合开始时先按顺序补发缓存帧，增量编码的参考帧随之推进
+  bool sampleFrame(
+      const cv::Mat &leftFrame,
+      const cv::Mat &rightFrame,
+      uint32_t frameId,
+      int64_t capturedUs) {
+    switch (sampler_.sample(event_clock::captureTime())) {
+      case FrameSampler::Action::Active:
+        for (const HeldFrame &held : pre_roll_)
+          publishFrame(held.left, held.right, held.frameId, held.capturedUs);
+        frames_pre_roll_ += pre_roll_.size();
+        pre_roll_.clear();
+        ++frames_active_;
+        return true;
+      case FrameSampler::Action::Idle:
+        dropPreRoll();
+        ++frames_idle_;
+        return true;
+      case FrameSampler::Action::Hold:
+        break;
+    }
+    // 缓存已满时丢弃最早的帧，不缓存时丢弃当前帧
+    if (pre_roll_.size() >= config_.sampling.preRollFrames) {
+      ++frames_dropped_;
+      if (pre_roll_.empty()) return false;
+      pre_roll_.pop_front();
+    }
+    HeldFrame held;
+    held.left = leftFrame;
+    held.right = rightFrame;
+    held.frameId = frameId;
+    held.capturedUs = capturedUs;
+    pre_roll_.push_back(std::move(held));
+    return false;
+  }
+
+  void dropPreRoll() {
+    frames_dropped_ += pre_roll_.size();
+    pre_roll_.clear();
+  }
+
+  // 球位置、轨迹和击球点事件表明回合进行中。按 emit 时刻判断，
+  // 遥测先于排队中的图像分发时也与图像的采集时间比较
+  void markActivity() {
+    if (config_.sampling.enabled) sampler_.activity(event_clock::captureTime());
+  }
+
+  void submitFrame(
+      const std::shared_ptr<StereoFrame> &stereo,
+      const cv::Mat &frame,
+      CameraSide side) {
+    encode_pool_.submit(
+        [this, stereo, frame, side] { encodeFrame(*stereo, frame, side); },
+        [this, stereo, side] { sendFrame(*stereo, side); });
+  }
+
+  // 编码线程中执行
+  void encodeFrame(StereoFrame &stereo, const cv::Mat &frame, CameraSide side) {
+    size_t index = static_cast<size_t>(side);
+    std::vector<unsigned char> &buf = stereo.encoded[index];
+    const FrameDelta &delta = stereo.delta[index];
+    bool isDelta = delta_[index].enabled() && !delta.keyframe;
+    auto start = now();
+    cv::Size size = frame.size();
+    if (!isDelta) {
+      size = image_encoder_.encode(frame, buf);
+    } else {
+      // 增量帧：头部、分块坐标，之后为拼接图像的 PNG，没有变化时只有头部
+      buf.clear();
+      if (!delta.image.empty()) image_encoder_.encode(delta.image, buf);
+      size_t header = frame_delta::headerSize(delta);
+      buf.insert(buf.begin(), header, 0);
+      frame_delta::writeHeader(delta, delta_[index].tileSize(), buf.data());
+    }
+    record(PipelineStage::Encode, EnumEventType::CameraStream, start);
+
+    frame_message::FramePart &part = stereo.parts[index];
+    part.event = static_cast<uint8_t>(EnumEventType::CameraStream);
+    part.side = side;
+    part.codec = isDelta ? ImageCodec::PngDelta : image_encoder_.codec();
+    part.gameId = stereo.gameId;
+    part.frameId = stereo.frameId;
+    part.rows = static_cast<uint32_t>(size.height);
+    part.cols = static_cast<uint32_t>(size.width);
+    part.type = frame.type();
+    part.baseFrameId = isDelta ? delta.baseFrameId : 0;
+    part.data = buf.data();
+    part.size = static_cast<uint32_t>(buf.size());
+
+    start = now();
+    if (config_.imageFormat == ImageWireFormat::Json) {
+      stereo.message[index] =
+          buffer_pool_.acquire(base64_encoded_size(buf.size()) + 192);
+      appendImageJson(
+          *stereo.message[index], imageEvent(side), part, stereo.capturedUs);
+      record(PipelineStage::Serialize, EnumEventType::CameraStream, start);
+      return;
+    }
+
+    if (config_.imageFormat == ImageWireFormat::Binary) {
+      size_t size = frame_message::encodedSize(&part, 1);
+      stereo.message[index] = buffer_pool_.acquire(size);
+      frame_message::encode(&part, 1, stereo.message[index]->grow(size));
+      record(PipelineStage::Serialize, EnumEventType::CameraStream, start);
+    }
+  }
+
+  // 按提交顺序执行
+  void sendFrame(StereoFrame &stereo, CameraSide side) {
+    size_t index = static_cast<size_t>(side);
+    if (config_.imageFormat == ImageWireFormat::BinaryStereo) {
+      // 右路提交时左路必然已完成，合并为一条消息
+      if (side != CameraSide::Right) return;
+      auto start = now();
+      size_t size = frame_message::encodedSize(stereo.parts, 2);
+      utils::PooledBuffer message = buffer_pool_.acquire(size);
+      frame_message::encode(stereo.parts, 2, message->grow(size));
+      record(PipelineStage::Serialize, EnumEventType::CameraStream, start);
+
+      start = now();
+      publisher::PublishOptions options = keyOptions(stereo.gameId);
+      stamp(options, eventName(EnumEventType::CameraStream), stereo.capturedUs);
+      publisher_->publish(topic_image_, std::move(message), options);
+      record(PipelineStage::Publish, EnumEventType::CameraStream, start);
+      return;
+    }
+    auto start = now();
+    publisher::PublishOptions options = keyOptions(stereo.gameId, side);
+    stamp(options, imageEvent(side), stereo.capturedUs);
+    publisher_->publish(topic_image_, std::move(stereo.message[index]), options);
+    record(PipelineStage::Publish, EnumEventType::CameraStream, start);
+  }
+
+  void publishTrack(EnumEventType type, const std::vector<cv::Point3f> &pos) {
+    if (!pos.empty()) markActivity();
+    uint32_t frameId = frame_id_.load();
+    int64_t captured = captureTimeUs();
+    auto fill = [&](TelemetryEvent &event) {
+      event.frameId = frameId;
+      event.timestampUs = captured;
+      event.positions.assign(pos.begin(), pos.end());
+    };
+    if (batching_) {
+      telemetry_.add(type, game_id_.load(), fill);
+      return;
+    }
+    // 复用同一条记录，轨迹点容量不再重新分配
+    track_event_.type = type;
+    track_event_.gameId = game_id_.load();
+    fill(track_event_);
+    publishEvent(track_event_);
+  }
+
+  void publishEvent(const TelemetryEvent &event) {
+    auto start = now();
+    utils::PooledBuffer message = telemetry_pool_.acquire(256);
+    serializer_->encode(event, *message);
+    record(PipelineStage::Serialize, event.type, start);
+
+    start = now();
+    publisher::PublishOptions options = keyOptions(event.gameId);
+    stamp(options, eventName(event.type), event.timestampUs);
+    publisher_->publish(topic_, std::move(message), options);
+    record(PipelineStage::Publish, event.type, start);
+  }
+
+  void publishBatch(const TelemetryEvent *events, size_t count) {
+    auto start = now();
+    utils::PooledBuffer message = telemetry_pool_.acquire(count * 96);
+    serializer_->encodeBatch(events, count, *message);
+    record(PipelineStage::Serialize, events[0].type, start);
+
+    // 批次按最早一条事件的采集时间统计
+    start = now();
+    publisher::PublishOptions options = keyOptions(events[0].gameId);
+    stamp(options, eventName(events[0].type), events[0].timestampUs);
+    publisher_->publish(topic_, std::move(message), options);
+    record(PipelineStage::Publish, events[0].type, start);
+  }
+
+  // 未开启统计时不读取时钟
+  PipelineMetrics::Clock::time_point now() const {
+    return config_.metrics ? PipelineMetrics::Clock::now()
+                           : PipelineMetrics::Clock::time_point();
+  }
+
+  void record(
+      PipelineStage stage,
+      EnumEventType type,
+      PipelineMetrics::Clock::time_point start) {
+    if (config_.metrics) config_.metrics->record(stage, type, start);
+  }
+
+  // 按发布统计周期性调整遥测批次，每次调整输出一行日志
+  void adjustBatches() {
+    auto interval =
+        std::chrono::milliseconds(std::max(1, config_.adaptiveBatch.intervalMs));
+    std::unique_lock<std::mutex> lock(batch_mutex_);
+    while (!batch_cv_.wait_for(lock, interval, [this] { return batch_stopping_; })) {
+      std::string reason;
+      if (!batch_controller_.update(publisher_->stats(), &reason)) continue;
+      const BatchLimits &limits = batch_controller_.limits();
+      telemetry_.setLimits(limits.items, limits.delayMs);
+      std::cerr << "Telemetry batching: " << reason << std::endl;
+    }
+  }
+
+  // 固定批次时条数为 1 不启用定时输出；自适应时限制在配置范围内
+  static BatchLimits initialLimits(const HookEventPublisherConfig &config) {
+    BatchLimits limits;
+    limits.items = config.telemetryBatchSize;
+    limits.delayMs = config.telemetryBatchSize > 1 ? config.telemetryBatchMs : 0;
+    if (!config.adaptiveBatch.enabled) return limits;
+    limits.delayMs = config.telemetryBatchMs;
+    return BatchController(config.adaptiveBatch, limits).limits();
+  }
+
+  // 当前事件的采集时间，未开启时为 0
+  int64_t captureTimeUs() const {
+    return config_.timestamps ? event_clock::captureWallUs() : 0;
+  }
+
+  // 消息时间戳取采集时间，消息头带事件名、采集时间和发布时间
+  void stamp(
+      publisher::PublishOptions &options, const char *event, int64_t capturedUs) const {
+    if (capturedUs <= 0) return;
+    options.timestampMs = capturedUs / 1000;
+    options.headers.reserve(3);
+    options.headers.emplace_back(event_clock::kHeaderEvent, event);
+    options.headers.emplace_back(
+        event_clock::kHeaderCaptureUs, std::to_string(capturedUs));
+    options.headers.emplace_back(
+        event_clock::kHeaderPublishUs, std::to_string(event_clock::wallUs()));
+  }
+
+  static const char *imageEvent(CameraSide side) {
+    return side == CameraSide::Left ? "camera_stream_left" : "camera_stream_right";
+  }
+
+  // 同一场比赛的事件按 game_id 分区，图像按 game_id 和摄像头分区，各自保持顺序
+  static publisher::PublishOptions keyOptions(uint32_t gameId) {
+    publisher::PublishOptions options;
+    options.key = std::to_string(gameId);
+    return options;
+  }
+
+  static publisher::PublishOptions keyOptions(uint32_t gameId, CameraSide side) {
+    publisher::PublishOptions options;
+    options.key =
+        std::to_string(gameId) + (side == CameraSide::Left ? ":left" : ":right");
+    return options;
+  }
+
+  // 增量编码使用无损 PNG
+  static ImageEncodeConfig deltaImageConfig(const ImageEncodeConfig &image) {
+    ImageEncodeConfig config;
+    config.level = image.level;
+    return config;
+  }
+
+  static bool isRaw(ImageCodec codec) {
+    return codec == ImageCodec::Raw || codec == ImageCodec::RawLz4 ||
+           codec == ImageCodec::RawZstd;
+  }
+
+  // 与 nlohmann::json::dump 输出一致（键按字母序），base64 直接写入缓冲区，
+  // 避免大字符串在 json 对象中的拷贝与转义扫描。
+  // 非 PNG 编码带 codec，增量帧带 base_frame_id，原始像素带 rows、cols、type，
+  // 记录了采集时间时带 timestamp（Unix 毫秒）
+  static void appendImageJson(
+      utils::ByteBuffer &out,
+      const char *event,
+      const frame_message::FramePart &part,
+      int64_t capturedUs) {
+    bool raw = isRaw(part.codec);
+    out.append("{");
+    if (part.codec == ImageCodec::PngDelta) {
+      out.append("\"base_frame_id\":");
+      out.append(std::to_string(part.baseFrameId).c_str());
+      out.append(",");
+    }
+    if (part.codec != ImageCodec::Png) {
+      out.append("\"codec\":\"");
+      out.append(codecName(part.codec));
+      out.append("\",");
+    }
+    if (raw) {
+      out.append("\"cols\":");
+      out.append(std::to_string(part.cols).c_str());
+      out.append(",");
+    }
+    out.append("\"data\":\"");
+    char *data = reinterpret_cast<char *>(out.grow(base64_encoded_size(part.size)));
+    encode_base64(part.data, part.size, data);
+    out.append("\",\"event\":\"");
+    out.append(event);
+    out.append("\",\"frame_id\":");
+    out.append(std::to_string(part.frameId).c_str());
+    out.append(",\"game_id\":");
+    out.append(std::to_string(part.gameId).c_str());
+    if (raw) {
+      out.append(",\"rows\":");
+      out.append(std::to_string(part.rows).c_str());
+    }
+    if (capturedUs > 0) {
+      out.append(",\"timestamp\":");
+      out.append(std::to_string(capturedUs / 1000).c_str());
+    }
+    if (raw) {
+      out.append(",\"type\":");
+      out.append(std::to_string(part.type).c_str());
+    }
+    out.append("}");
+  }
 
  private:
   const std::string topic_;
@@ -114,6 +560,32 @@ class HookEventPublisher : public EventMessage {
   std::atomic<uint32_t> game_id_{0};
   std::atomic<uint32_t> frame_id_{0};
   std::shared_ptr<publisher::BasePublisher> publisher_;
+  const HookEventPublisherConfig config_;
+  utils::BufferPool buffer_pool_;
+  utils::OrderedTaskPool encode_pool_;
+  const ImageEncoder image_encoder_;
+  // 左右两路各自的参考帧，只在处理图像事件的线程（多线程时为图像 strand）中访问
+  FrameDeltaEncoder delta_[2];
+  // sample 与 pre_roll_ 同样只在图像事件的线程中访问
+  FrameSampler sampler_;
+  std::deque<HeldFrame> pre_roll_;
+  std::atomic<uint64_t> frames_active_{0};
+  std::atomic<uint64_t> frames_idle_{0};
+  std::atomic<uint64_t> frames_pre_roll_{0};
+  std::atomic<uint64_t> frames_dropped_{0};
+  std::shared_ptr<EventSerializer> serializer_;
+  utils::BufferPool telemetry_pool_;
+  // 轨迹事件的复用记录，只在处理遥测事件的线程（多线程时为遥测 strand）中访问
+  TelemetryEvent track_event_;
+  // 遥测事件是否经过 telemetry_ 合并
+  const bool batching_;
+  // 只在 batch_thread_ 中调用 update
+  BatchController batch_controller_;
+  std::mutex batch_mutex_;
+  std::condition_variable batch_cv_;
+  bool batch_stopping_ = false;
+  std::thread batch_thread_;
+  TelemetryBatcher telemetry_;
 };
 
 };  // namespace hook_event::event
\ No newline at end of file
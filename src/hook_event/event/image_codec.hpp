@@ -0,0 +1,258 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <opencv2/opencv.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef HOOK_EVENT_WITH_LZ4
+#include <lz4.h>
+#endif
+#ifdef HOOK_EVENT_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "./frame_message.hpp"
+
+namespace hook_event::event {
+
+// 图像编码配置
+// Raw 系列发送连续的原始像素（按 rows、cols、cv type 解释），
+// RawLz4 / RawZstd 需在编译时开启 HOOK_EVENT_WITH_LZ4 / HOOK_EVENT_WITH_ZSTD
+struct ImageEncodeConfig {
+  ImageCodec codec = ImageCodec::Png;
+  // PNG 0-9，-1 为 OpenCV 默认；zstd 1-22；LZ4 为加速系数，越大越快
+  int level = -1;
+  // JPEG / WebP 质量 1-100，WebP 大于 100 为无损
+  int quality = 90;
+  // 编码前缩放比例 (0, 1]，1 为原尺寸
+  double scale = 1.0;
+};
+
+inline const char *codecName(ImageCodec codec) {
+  switch (codec) {
+    case ImageCodec::Png:
+      return "png";
+    case ImageCodec::PngDelta:
+      return "png_delta";
+    case ImageCodec::Jpeg:
+      return "jpeg";
+    case ImageCodec::Webp:
+      return "webp";
+    case ImageCodec::Raw:
+      return "raw";
+    case ImageCodec::RawLz4:
+      return "raw_lz4";
+    case ImageCodec::RawZstd:
+      return "raw_zstd";
+  }
+  return "";
+}
+
+// 当前编译是否支持该编码
+inline bool codecSupported(ImageCodec codec) {
+  switch (codec) {
+    case ImageCodec::RawLz4:
+#ifdef HOOK_EVENT_WITH_LZ4
+      return true;
+#else
+      return false;
+#endif
+    case ImageCodec::RawZstd:
+#ifdef HOOK_EVENT_WITH_ZSTD
+      return true;
+#else
+      return false;
+#endif
+    case ImageCodec::PngDelta:
+      return false;  // 由 FrameDeltaEncoder 产生
+    default:
+      return true;
+  }
+}
+
+// 单帧图像编码，构造后只读，可在多个编码线程中同时使用
+class ImageEncoder {
+ public:
+  explicit ImageEncoder(const ImageEncodeConfig &config = ImageEncodeConfig())
+      : config_(config) {
+    if (!codecSupported(config.codec))
+      throw std::runtime_error(
+          std::string("image codec not supported: ") + codecName(config.codec));
+    if (!(config.scale > 0 && config.scale <= 1))
+      throw std::runtime_error("image scale must be in (0, 1]");
+    switch (config.codec) {
+      case ImageCodec::Png:
+        ext_ = ".png";
+        if (config.level >= 0) params_ = {cv::IMWRITE_PNG_COMPRESSION, config.level};
+        break;
+      case ImageCodec::Jpeg:
+        ext_ = ".jpg";
+        params_ = {cv::IMWRITE_JPEG_QUALITY, config.quality};
+        break;
+      case ImageCodec::Webp:
+        ext_ = ".webp";
+        params_ = {cv::IMWRITE_WEBP_QUALITY, config.quality};
+        break;
+      default:
+        break;
+    }
+  }
+
+  ImageCodec codec() const {
+    return config_.codec;
+  }
+
+  // 编码结果写入 out，返回编码图像（缩放后）的尺寸
+  cv::Size encode(const cv::Mat &frame, std::vector<unsigned char> &out) const {
+    cv::Mat scaled;
+    const cv::Mat *image = &frame;
+    if (config_.scale < 1) {
+      cv::resize(
+          frame, scaled, cv::Size(), config_.scale, config_.scale, cv::INTER_AREA);
+      image = &scaled;
+    }
+
+    switch (config_.codec) {
+      case ImageCodec::Raw:
+        out.resize(rawSize(*image));
+        copyRaw(*image, out.data());
+        break;
+      case ImageCodec::RawLz4:
+      case ImageCodec::RawZstd:
+        compressRaw(*image, out);
+        break;
+      default:
+        cv::imencode(ext_, *image, out, params_);
+        break;
+    }
+    return image->size();
+  }
+
+  static size_t rawSize(const cv::Mat &image) {
+    return image.total() * image.elemSize();
+  }
+
+ private:
+  static void copyRaw(const cv::Mat &image, unsigned char *out) {
+    size_t row = static_cast<size_t>(image.cols) * image.elemSize();
+    if (image.isContinuous()) {
+      std::memcpy(out, image.ptr(0), row * image.rows);
+      return;
+    }
+    for (int y = 0; y < image.rows; ++y) std::memcpy(out + y * row, image.ptr(y), row);
+  }
+
+  void compressRaw(const cv::Mat &image, std::vector<unsigned char> &out) const {
+    size_t size = rawSize(image);
+    std::vector<unsigned char> contiguous;
+    const unsigned char *src = image.ptr(0);
+    if (!image.isContinuous()) {
+      contiguous.resize(size);
+      copyRaw(image, contiguous.data());
+      src = contiguous.data();
+    }
+#ifdef HOOK_EVENT_WITH_LZ4
+    if (config_.codec == ImageCodec::RawLz4) {
+      out.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(size))));
+      int n = LZ4_compress_fast(
+          reinterpret_cast<const char *>(src),
+          reinterpret_cast<char *>(out.data()),
+          static_cast<int>(size),
+          static_cast<int>(out.size()),
+          config_.level > 0 ? config_.level : 1);
+      if (n <= 0) throw std::runtime_error("LZ4 compression failed");
+      out.resize(static_cast<size_t>(n));
+      return;
+    }
+#endif
+#ifdef HOOK_EVENT_WITH_ZSTD
+    if (config_.codec == ImageCodec::RawZstd) {
+      out.resize(ZSTD_compressBound(size));
+      size_t n = ZSTD_compress(
+          out.data(), out.size(), src, size, config_.level > 0 ? config_.level : 1);
+      if (ZSTD_isError(n))
+        throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(n));
+      out.resize(n);
+      return;
+    }
+#endif
+    (void)src;
+    throw std::runtime_error("image codec not supported");
+  }
+
+  ImageEncodeConfig config_;
+  std::string ext_;
+  std::vector<int> params_;
+};
+
+// 原始像素解码的大小上限，防止损坏的尺寸字段触发超大分配
+const size_t kMaxRawImageBytes = size_t(1) << 29;
+
+// 校验原始像素分片的尺寸和类型，通过时给出像素字节数
+inline bool rawImageSize(const frame_message::FramePart &part, size_t &size) {
+  if (part.rows == 0 || part.cols == 0 || part.rows > INT_MAX || part.cols > INT_MAX)
+    return false;
+  int depth = CV_MAT_DEPTH(part.type);
+  int channels = CV_MAT_CN(part.type);
+  if (part.type != CV_MAKETYPE(depth, channels) || depth > CV_64F || channels > 4)
+    return false;
+  size_t elemSize = CV_ELEM_SIZE(part.type);
+  uint64_t pixels = uint64_t(part.rows) * part.cols;
+  if (pixels > kMaxRawImageBytes / elemSize) return false;
+  size = static_cast<size_t>(pixels) * elemSize;
+  return true;
+}
+
+// 解码一个图像分片（增量帧除外），失败返回空图像
+inline cv::Mat decodeImage(const frame_message::FramePart &part) {
+  cv::Mat buf(
+      1, static_cast<int>(part.size), CV_8UC1, const_cast<unsigned char *>(part.data));
+  switch (part.codec) {
+    case ImageCodec::Png:
+    case ImageCodec::Jpeg:
+    case ImageCodec::Webp:
+      return part.size ? cv::imdecode(buf, cv::IMREAD_UNCHANGED) : cv::Mat();
+    case ImageCodec::Raw:
+    case ImageCodec::RawLz4:
+    case ImageCodec::RawZstd:
+      break;
+    default:
+      return cv::Mat();
+  }
+
+  // 先校验头部字段再分配
+  size_t size = 0;
+  if (!rawImageSize(part, size)) return cv::Mat();
+  if (part.codec == ImageCodec::Raw && part.size != size) return cv::Mat();
+  cv::Mat image(static_cast<int>(part.rows), static_cast<int>(part.cols), part.type);
+  unsigned char *dst = image.ptr(0);
+  switch (part.codec) {
+    case ImageCodec::Raw:
+      std::memcpy(dst, part.data, size);
+      return image;
+#ifdef HOOK_EVENT_WITH_LZ4
+    case ImageCodec::RawLz4: {
+      int n = LZ4_decompress_safe(
+          reinterpret_cast<const char *>(part.data),
+          reinterpret_cast<char *>(dst),
+          static_cast<int>(part.size),
+          static_cast<int>(size));
+      return n >= 0 && static_cast<size_t>(n) == size ? image : cv::Mat();
+    }
+#endif
+#ifdef HOOK_EVENT_WITH_ZSTD
+    case ImageCodec::RawZstd: {
+      size_t n = ZSTD_decompress(dst, size, part.data, part.size);
+      return !ZSTD_isError(n) && n == size ? image : cv::Mat();
+    }
+#endif
+    default:
+      return cv::Mat();
+  }
+}
+
+};  // namespace hook_event::event
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../utils/histogram.hpp"
+#include "./event_clock.hpp"
+
+namespace hook_event::event {
+
+// 单个事件类型的延迟分布，单位微秒
+struct LatencyStats {
+  std::string event;
+  // 采集（emit）到消费者收到
+  utils::HistogramSnapshot endToEndUs;
+  // 采集到交给发布器，即事件队列、编码及序列化
+  utils::HistogramSnapshot pipelineUs;
+  // 接收时间早于采集时间的消息数，多为主机间时钟偏差，按 0 计入
+  uint64_t skewed = 0;
+};
+
+// 端到端延迟统计，按 HookEventPublisher 写入的消息头（见 event_clock）计算，
+// 与发送端跨主机比较时须保证时钟同步。非线程安全
+class LatencyProbe {
+ public:
+  typedef std::vector<std::pair<std::string, std::string>> Headers;
+
+  // 时间均为 Unix 微秒，publishUs 为 0 时只统计端到端延迟
+  void record(
+      const std::string &event,
+      int64_t captureUs,
+      int64_t publishUs,
+      int64_t receivedUs) {
+    std::unique_ptr<Entry> &entry = entries_[event];
+    if (!entry) entry.reset(new Entry());
+    if (receivedUs < captureUs) ++entry->skewed;
+    entry->endToEnd.record(elapsed(captureUs, receivedUs));
+    if (publishUs) entry->pipeline.record(elapsed(captureUs, publishUs));
+  }
+
+  // 从消息头读取事件名和时间，缺少事件名或采集时间时返回 false
+  bool record(const Headers &headers, int64_t receivedUs) {
+    const std::string *event = nullptr;
+    int64_t captureUs = 0;
+    int64_t publishUs = 0;
+    for (const auto &header : headers) {
+      if (header.first == event_clock::kHeaderEvent)
+        event = &header.second;
+      else if (header.first == event_clock::kHeaderCaptureUs)
+        captureUs = parse(header.second);
+      else if (header.first == event_clock::kHeaderPublishUs)
+        publishUs = parse(header.second);
+    }
+    if (!event || captureUs <= 0) return false;
+    record(*event, captureUs, publishUs, receivedUs);
+    return true;
+  }
+
+  // 按事件名排序
+  std::vector<LatencyStats> stats() const {
+    std::vector<LatencyStats> result;
+    for (const auto &kv : entries_) {
+      LatencyStats stats;
+      stats.event = kv.first;
+      stats.endToEndUs = kv.second->endToEnd.snapshot();
+      stats.pipelineUs = kv.second->pipeline.snapshot();
+      stats.skewed = kv.second->skewed;
+      result.push_back(stats);
+    }
+    return result;
+  }
+
+  // 每个事件类型一行，单位毫秒
+  std::string report() const {
+    std::string out;
+    char line[192];
+    std::snprintf(
+        line,
+        sizeof(line),
+        "%-26s %8s %9s %9s %9s %9s %13s\n",
+        "event",
+        "count",
+        "p50_ms",
+        "p99_ms",
+        "p999_ms",
+        "max_ms",
+        "pipe_p99_ms");
+    out += line;
+    for (const auto &stats : this->stats()) {
+      const utils::HistogramSnapshot &e2e = stats.endToEndUs;
+      std::snprintf(
+          line,
+          sizeof(line),
+          "%-26s %8llu %9.3f %9.3f %9.3f %9.3f %13.3f\n",
+          stats.event.c_str(),
+          static_cast<unsigned long long>(e2e.count),
+          e2e.p50 / 1000.0,
+          e2e.p99 / 1000.0,
+          e2e.p999 / 1000.0,
+          e2e.max / 1000.0,
+          stats.pipelineUs.p99 / 1000.0);
+      out += line;
+    }
+    return out;
+  }
+
+  void reset() {
+    entries_.clear();
+  }
+
+ private:
+  struct Entry {
+    utils::Histogram endToEnd;
+    utils::Histogram pipeline;
+    uint64_t skewed = 0;
+  };
+
+  static uint64_t elapsed(int64_t from, int64_t to) {
+    return to > from ? static_cast<uint64_t>(to - from) : 0;
+  }
+
+  static int64_t parse(const std::string &value) {
+    char *end = nullptr;
+    long long parsed = std::strtoll(value.c_str(), &end, 10);
+    return end && *end == '\0' ? static_cast<int64_t>(parsed) : 0;
+  }
+
+  std::map<std::string, std::unique_ptr<Entry>> entries_;
+};
+
+};  // namespace hook_event::event
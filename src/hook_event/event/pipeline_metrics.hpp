@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "../utils/histogram.hpp"
+#include "./event_type.hpp"
+
+namespace hook_event::event {
+
+// 事件处理阶段
+enum class PipelineStage {
+  Queue = 0,  /// emit 到回调开始，事件队列中的等待时间
+  Encode,     /// cv::imencode
+  Serialize,  /// base64 / JSON / 二进制封装
+  Publish,    /// 调用 publisher 发布（Kafka 为入队 librdkafka）
+};
+
+const size_t kPipelineStageCount = static_cast<size_t>(PipelineStage::Publish) + 1;
+
+inline const char *stageName(PipelineStage stage) {
+  switch (stage) {
+    case PipelineStage::Queue:
+      return "queue";
+    case PipelineStage::Encode:
+      return "encode";
+    case PipelineStage::Serialize:
+      return "serialize";
+    case PipelineStage::Publish:
+      return "publish";
+  }
+  return "";
+}
+
+// 各阶段、各事件类型的耗时直方图，单位微秒
+// 由 EventManager 和 HookEventPublisher 共享，通过各自配置中的 metrics 传入
+class PipelineMetrics {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  void record(PipelineStage stage, EnumEventType type, uint64_t us) {
+    histograms_[static_cast<size_t>(stage)][type].record(us);
+  }
+
+  void record(PipelineStage stage, EnumEventType type, Clock::time_point start) {
+    record(stage, type, elapsedUs(start));
+  }
+
+  const utils::Histogram &histogram(PipelineStage stage, EnumEventType type) const {
+    return histograms_[static_cast<size_t>(stage)][type];
+  }
+
+  static uint64_t elapsedUs(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start)
+            .count());
+  }
+
+ private:
+  utils::Histogram histograms_[kPipelineStageCount][kEventTypeCount];
+};
+
+};  // namespace hook_event::event
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <vector>
+
+#include "../utils/mpmc_ring.hpp"
+#include "../utils/thread_affinity.hpp"
+#include "./event_clock.hpp"
+#include "./event_message.hpp"
+#include "./event_queue.hpp"
+#include "./event_type.hpp"
+#include "./pipeline_metrics.hpp"
+
+namespace hook_event::event {
+
+// 环形队列中的事件记录，按 type 解释各字段
+struct EventRecord {
+  // 调用一个回调，由写入记录的一方按事件类型设置，分发时不再判断类型
+  typedef void (*Dispatch)(EventMessage &cb, const EventRecord &rec);
+
+  EnumEventType type = EnumEventType::MatchStart;
+  Dispatch dispatch = nullptr;
+  cv::Mat leftFrame;
+  cv::Mat rightFrame;
+  cv::Point2f leftPos;
+  cv::Point2f rightPos;
+  cv::Point3f point;
+  std::vector<cv::Point3f> points;
+  size_t frameBytes = 0;
+  PipelineMetrics::Clock::time_point enqueued;  // emit 时刻
+};
+
+// 无锁事件分发
+// 生产者将事件原地写入预分配的环形队列，事件线程直接调用 EventMessage 回调，
+// 不经过 asio handler，稳定状态下不产生内存分配。
+// 回调须在 start 之前通过 EventManager::addCallback 注册。
+//
+// 容量由环形队列大小和 EventQueueConfig 共同限制，溢出策略中：
+// DropOldest 无法撤销已入队的记录，按 DropNewest 处理。
+class RingDispatcher {
+ public:
+  RingDispatcher(
+      const EventQueueConfig &config,
+      size_t capacity,
+      size_t reservePoints,
+      const std::vector<std::shared_ptr<EventMessage>> &callbacks,
+      PipelineMetrics *metrics = nullptr)
+      : config_(config),
+        ring_(capacity),
+        callbacks_(callbacks),
+        metrics_(metrics),
+        running_(false) {
+    ring_.initSlots([reservePoints](EventRecord &rec) {
+      rec.points.reserve(reservePoints);
+    });
+    for (size_t i = 0; i < kEventTypeCount; ++i) {
+      emitted_[i].store(0);
+      dropped_[i].store(0);
+    }
+  }
+
+  ~RingDispatcher() {
+    stop();
+  }
+
+  // cpu 不小于 0 时事件线程绑定到该 CPU
+  void start(int cpu = -1) {
+    if (running_.load()) return;
+    running_.store(true);
+    thread_ = std::thread([this, cpu] {
+      utils::pinCurrentThread(cpu);
+      run();
+    });
+  }
+
+  void stop() {
+    if (!running_.load()) return;
+    running_.store(false);
+    wakeup();
+    if (thread_.joinable()) thread_.join();
+  }
+
+  // 在调用线程中分发所有已排队事件
+  size_t poll() {
+    size_t count = 0;
+    while (dispatchOne()) ++count;
+    return count;
+  }
+
+  // fill(EventRecord &) 写入事件内容及 dispatch
+  template <typename Fill>
+  void push(EnumEventType type, size_t frameBytes, Fill fill) {
+    bool control = isControlEvent(type);
+    bool blocked = false;
+    while (true) {
+      if (control || fits(frameBytes)) {
+        // 先计入字节数，避免消费者先于计数出队
+        frameBytes_.fetch_add(frameBytes);
+        bool pushed = ring_.tryPush([&](EventRecord &rec) {
+          rec.type = type;
+          rec.frameBytes = frameBytes;
+          rec.enqueued = PipelineMetrics::Clock::now();
+          fill(rec);
+        });
+        if (pushed) break;
+        frameBytes_.fetch_sub(frameBytes);
+      }
+
+      // 队列满
+      if (!control && config_.policy(type) != OverflowPolicy::Block) {
+        dropped_[type].fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      if (!mayBlock()) {
+        // 事件线程内无法等待，控制事件就地分发一条腾出空间，其他事件丢弃
+        if (control && dispatchOne()) continue;
+        if (!control) {
+          dropped_[type].fetch_add(1, std::memory_order_relaxed);
+          return;
+        }
+      }
+      if (!blocked) blocked_.fetch_add(1, std::memory_order_relaxed);
+      blocked = true;
+      std::this_thread::yield();
+    }
+
+    emitted_[type].fetch_add(1, std::memory_order_relaxed);
+    updateHighWater(highWaterEvents_, ring_.size());
+    if (frameBytes) updateHighWater(highWaterFrameBytes_, frameBytes_.load());
+    if (sleeping_.load()) wakeup();
+  }
+
+  EventQueueStats stats() const {
+    EventQueueStats stats;
+    stats.events = ring_.size();
+    stats.frameBytes = frameBytes_.load();
+    stats.highWaterEvents = highWaterEvents_.load();
+    stats.highWaterFrameBytes = highWaterFrameBytes_.load();
+    stats.blocked = blocked_.load();
+    for (size_t i = 0; i < kEventTypeCount; ++i) {
+      stats.emitted[i] = emitted_[i].load();
+      stats.dropped[i] = dropped_[i].load();
+    }
+    return stats;
+  }
+
+  bool isDispatchThread() const {
+    return std::this_thread::get_id() == thread_.get_id();
+  }
+
+ private:
+  void run() {
+    size_t idle = 0;
+    while (running_.load()) {
+      if (dispatchOne()) {
+        idle = 0;
+        continue;
+      }
+      // 先自旋，再让出，最后休眠等待唤醒
+      if (++idle < 64) continue;
+      if (idle < 128) {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(idleMutex_);
+      sleeping_.store(true);
+      if (ring_.empty() && running_.load())
+        idleCv_.wait_for(lock, std::chrono::milliseconds(1));
+      sleeping_.store(false);
+    }
+  }
+
+  bool dispatchOne() {
+    return ring_.tryPop([this](EventRecord &rec) {
+      if (rec.frameBytes) frameBytes_.fetch_sub(rec.frameBytes);
+      if (metrics_) metrics_->record(PipelineStage::Queue, rec.type, rec.enqueued);
+      event_clock::CaptureScope capture(rec.enqueued);
+      for (const auto &cb : callbacks_) rec.dispatch(*cb, rec);
+      // 释放图像引用，保留 points 容量供下次复用
+      rec.leftFrame.release();
+      rec.rightFrame.release();
+      rec.points.clear();
+    });
+  }
+
+  bool fits(size_t frameBytes) const {
+    if (config_.maxEvents && ring_.size() >= config_.maxEvents) return false;
+    if (!config_.maxFrameBytes || !frameBytes) return true;
+    size_t queued = frameBytes_.load();
+    return queued == 0 || queued + frameBytes <= config_.maxFrameBytes;
+  }
+
+  bool mayBlock() const {
+    return running_.load() && !isDispatchThread();
+  }
+
+  void wakeup() {
+    std::lock_guard<std::mutex> lock(idleMutex_);
+    idleCv_.notify_one();
+  }
+
+  static void updateHighWater(std::atomic<size_t> &mark, size_t value) {
+    size_t current = mark.load(std::memory_order_relaxed);
+    while (value > current &&
+           !mark.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+  }
+
+ private:
+  const EventQueueConfig config_;
+  utils::MpmcRing<EventRecord> ring_;
+  const std::vector<std::shared_ptr<EventMessage>> &callbacks_;
+  PipelineMetrics *const metrics_;
+  std::thread thread_;
+  std::atomic<bool> running_;
+  std::atomic<bool> sleeping_{false};
+  std::mutex idleMutex_;
+  std::condition_variable idleCv_;
+
+  std::atomic<size_t> frameBytes_{0};
+  std::atomic<size_t> highWaterEvents_{0};
+  std::atomic<size_t> highWaterFrameBytes_{0};
+  std::atomic<uint64_t> blocked_{0};
+  std::atomic<uint64_t> emitted_[kEventTypeCount];
+  std::atomic<uint64_t> dropped_[kEventTypeCount];
+};
+
+};  // namespace hook_event::event
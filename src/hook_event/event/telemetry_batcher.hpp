@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "./event_serializer.hpp"
+#include "./event_type.hpp"
+
+namespace hook_event::event {
+
+// 遥测数据合并
+// 高频小事件（球位置、轨迹点）按事件类型缓存，累计 maxItems 条或最早一条等待
+// maxDelayMs 毫秒后合并为一批交给 sink，以先满足者为准。比赛切换时先输出旧批次。
+// sink 在持有内部锁时调用，保证批次按产生顺序输出。
+// 缓存的事件记录循环复用，稳定状态下不产生内存分配。
+class TelemetryBatcher {
+ public:
+  // events 为同类型、同 game_id 的一批事件
+  typedef std::function<void(const TelemetryEvent *events, size_t count)> Sink;
+
+  // maxDelayMs 为 0 时只按条数合并
+  TelemetryBatcher(size_t maxItems, int maxDelayMs, Sink sink)
+      : max_items_(maxItems ? maxItems : 1),
+        max_delay_(maxDelayMs),
+        sink_(sink),
+        running_(maxDelayMs > 0),
+        game_id_(0),
+        count_(0) {
+    for (size_t i = 0; i < kEventTypeCount; ++i) sizes_[i] = 0;
+    if (running_) thread_ = std::thread([this] { run(); });
+  }
+
+  ~TelemetryBatcher() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      running_ = false;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+    flush();
+  }
+
+  // fill(TelemetryEvent &) 写入 type、gameId 以外的字段，记录为复用对象
+  template <typename Fill>
+  void add(EnumEventType type, uint32_t gameId, Fill fill) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ && gameId != game_id_) flushLocked();
+    game_id_ = gameId;
+    if (count_ == 0) {
+      deadline_ = std::chrono::steady_clock::now() + max_delay_;
+      cv_.notify_one();
+    }
+
+    std::vector<TelemetryEvent> &batch = batches_[type];
+    if (sizes_[type] == batch.size()) batch.emplace_back();
+    TelemetryEvent &event = batch[sizes_[type]++];
+    event.type = type;
+    event.gameId = gameId;
+    fill(event);
+    if (++count_ >= max_items_) flushLocked();
+  }
+
+  // 运行中调整合并条数和等待时间（见 BatchController），当前批次已满时立即输出。
+  // 只在构造时开启了定时输出（maxDelayMs 大于 0）时调整等待时间
+  void setLimits(size_t maxItems, int maxDelayMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_items_ = maxItems ? maxItems : 1;
+    if (thread_.joinable() && maxDelayMs > 0)
+      max_delay_ = std::chrono::milliseconds(maxDelayMs);
+    if (count_ >= max_items_) flushLocked();
+  }
+
+  // 立即输出所有缓存数据
+  void flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    flushLocked();
+  }
+
+  size_t pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+  }
+
+ private:
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+      if (count_ == 0) {
+        cv_.wait(lock);
+        continue;
+      }
+      if (cv_.wait_until(lock, deadline_) == std::cv_status::timeout && count_ &&
+          std::chrono::steady_clock::now() >= deadline_)
+        flushLocked();
+    }
+  }
+
+  void flushLocked() {
+    if (count_ == 0) return;
+    for (size_t i = 0; i < kEventTypeCount; ++i) {
+      if (!sizes_[i]) continue;
+      try {
+        sink_(batches_[i].data(), sizes_[i]);
+      } catch (const std::exception &ex) {
+        std::cerr << "Telemetry batch failed: " << ex.what() << std::endl;
+      }
+      sizes_[i] = 0;
+    }
+    count_ = 0;
+  }
+
+ private:
+  size_t max_items_;
+  std::chrono::milliseconds max_delay_;
+  const Sink sink_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+  bool running_;
+
+  uint32_t game_id_;
+  size_t count_;
+  std::chrono::steady_clock::time_point deadline_;
+  std::vector<TelemetryEvent> batches_[kEventTypeCount];
+  size_t sizes_[kEventTypeCount];
+};
+
+};  // namespace hook_event::event
@@ -5,20 +5,113 @@
 
 namespace hook_event {
 
+// 运行指标快照，可通过 toJson 输出供采集
+struct HookEventMetrics {
+  // 各阶段、各事件类型的耗时分布，单位微秒
+  utils::HistogramSnapshot stages[event::kPipelineStageCount][event::kEventTypeCount];
+  event::EventQueueStats queue;
+  publisher::PublisherStats publisher;
+
+  std::string toJson() const {
+    nlohmann::json json;
+    nlohmann::json &stageJson = json["stages"];
+    stageJson = nlohmann::json::object();
+    for (size_t i = 0; i < event::kPipelineStageCount; ++i) {
+      for (size_t j = 0; j < event::kEventTypeCount; ++j) {
+        const utils::HistogramSnapshot &h = stages[i][j];
+        if (!h.count) continue;
+        stageJson[event::stageName(static_cast<event::PipelineStage>(i))]
+                 [event::eventName(static_cast<event::EnumEventType>(j))] = histogram(h);
+      }
+    }
+
+    nlohmann::json &queueJson = json["queue"];
+    queueJson = {
+        {"events", queue.events},
+        {"frame_bytes", queue.frameBytes},
+        {"high_water_events", queue.highWaterEvents},
+        {"high_water_frame_bytes", queue.highWaterFrameBytes},
+        {"blocked", queue.blocked},
+    };
+    for (size_t i = 0; i < event::kEventTypeCount; ++i) {
+      const char *name = event::eventName(static_cast<event::EnumEventType>(i));
+      queueJson["emitted"][name] = queue.emitted[i];
+      queueJson["dropped"][name] = queue.dropped[i];
+    }
+    for (size_t i = 0; i < event::kEventLaneCount; ++i) {
+      const event::EventLaneStats &lane = queue.lanes[i];
+      queueJson["lanes"][event::laneName(static_cast<event::EventLane>(i))] = {
+          {"events", lane.events},
+          {"high_water_events", lane.highWaterEvents},
+          {"dispatched", lane.dispatched},
+          {"wait_us", histogram(lane.waitUs)},
+      };
+    }
+
+    json["publisher"] = {
+        {"in_flight_messages", publisher.inFlightMessages},
+        {"in_flight_bytes", publisher.inFlightBytes},
+        {"delivered", publisher.delivered},
+        {"failed", publisher.failed},
+        {"delivery_latency_us", histogram(publisher.deliveryLatencyUs)},
+        {"stats_updates", publisher.statsUpdates},
+        {"queue_messages", publisher.queueMessages},
+        {"queue_bytes", publisher.queueBytes},
+        {"broker_outbuf_messages", publisher.brokerOutbufMessages},
+        {"rtt_avg_us", publisher.rttAvgUs},
+        {"rtt_p99_us", publisher.rttP99Us},
+        {"batch_size_avg", publisher.batchSizeAvg},
+        {"batch_size_p99", publisher.batchSizeP99},
+        {"batch_count_avg", publisher.batchCountAvg},
+        {"spilled_messages", publisher.spilledMessages},
+        {"replayed_messages", publisher.replayedMessages},
+        {"spill_dropped", publisher.spillDropped},
+        {"spill_pending_messages", publisher.spillPendingMessages},
+        {"spill_pending_bytes", publisher.spillPendingBytes},
+    };
+    return json.dump();
+  }
+
+  static nlohmann::json histogram(const utils::HistogramSnapshot &h) {
+    return {
+        {"count", h.count},
+        {"mean", h.mean()},
+        {"min", h.min},
+        {"max", h.max},
+        {"p50", h.p50},
+        {"p90", h.p90},
+        {"p99", h.p99},
+        {"p999", h.p999},
+    };
+  }
+};
+
 class HookEvent {
  public:
   HookEvent(
       std::string broker = "localhost:9092",
       std::string topic = "test",
-      std::string topic_image = "test_image") {
+      std::string topic_image = "test_image")
+      : HookEvent(kafkaPublisher(broker), topic, topic_image) {}
+
+  // 使用指定的发布器及配置，如压测时使用 NullPublisher；
+  // 两个配置中的 metrics 被替换为共用的统计对象
+  HookEvent(
+      std::shared_ptr<publisher::BasePublisher> publisher,
+      std::string topic,
+      std::string topic_image,
+      event::EventManagerConfig managerConfig = event::EventManagerConfig(),
+      event::HookEventPublisherConfig eventConfig = event::HookEventPublisherConfig()) {
     // 初始化消息中间件
-    publisher::KafkaPublisherConfig config;
-    config.bootstrapServers = broker;
-    publisher_ = publisher::PublisherFactory::createKafkaPublisher(config);
-    auto event = std::make_shared<event::HookEventPublisher>(publisher_);
+    publisher_ = publisher;
+    metrics_ = std::make_shared<event::PipelineMetrics>();
+    eventConfig.metrics = metrics_;
+    auto event = std::make_shared<event::HookEventPublisher>(
+        publisher_, topic, topic_image, eventConfig);
 
     // 初始化消息管理对象
-    manager_ = std::make_shared<event::EventManager>();
+    managerConfig.metrics = metrics_;
+    manager_ = std::make_shared<event::EventManager>(managerConfig);
     manager_->addCallback(event);
     manager_->start();
     topic_ = topic;
@@ -50,7 +143,36 @@ class HookEvent {
     return *manager_;
   }
 
+  // 各阶段耗时、队列及 Kafka 统计
+  HookEventMetrics metrics() const {
+    HookEventMetrics snapshot;
+    for (size_t i = 0; i < event::kPipelineStageCount; ++i) {
+      for (size_t j = 0; j < event::kEventTypeCount; ++j) {
+        snapshot.stages[i][j] =
+            metrics_
+                ->histogram(
+                    static_cast<event::PipelineStage>(i),
+                    static_cast<event::EnumEventType>(j))
+                .snapshot();
+      }
+    }
+    snapshot.queue = manager_->queueStats();
+    snapshot.publisher = publisher_->stats();
+    return snapshot;
+  }
+
+  std::string metricsJson() const {
+    return metrics().toJson();
+  }
+
  private:
+  static std::shared_ptr<publisher::BasePublisher> kafkaPublisher(
+      const std::string &broker) {
+    publisher::KafkaPublisherConfig config;
+    config.bootstrapServers = broker;
+    return publisher::PublisherFactory::createKafkaPublisher(config);
+  }
+
   // 禁止拷贝和赋值
   //   HookEvent(const HookEvent&) = delete;
   //   HookEvent& operator=(const HookEvent&) = delete;
@@ -60,6 +182,7 @@ class HookEvent {
  public:
   std::shared_ptr<event::EventManager> manager_;
   std::shared_ptr<publisher::BasePublisher> publisher_;
+  std::shared_ptr<event::PipelineMetrics> metrics_;
   std::string topic_;
   std::string topic_image_;
 };
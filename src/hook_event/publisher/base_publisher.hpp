@@ -1,11 +1,72 @@
 #pragma once
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "../utils/buffer_pool.hpp"
+#include "../utils/histogram.hpp"
 
 namespace hook_event::publisher {
 
+// 消息最终投递结果
+struct PublishResult {
+  bool ok = false;
+  int errorCode = 0;  // 中间件错误码，0 表示成功
+  std::string error;
+  std::string topic;
+  int32_t partition = -1;
+  int64_t offset = -1;
+  int64_t latencyUs = 0;  // 入队到确认的耗时
+};
+
+typedef std::function<void(const PublishResult &)> PublishCallback;
+
+// 单条消息的发布选项
+struct PublishOptions {
+  // 消息键，相同键的消息进入同一分区并保持顺序，空表示不指定
+  std::string key;
+  // 消息时间戳，Unix 毫秒，0 表示由中间件取当前时间
+  int64_t timestampMs = 0;
+  // 消息头（名称、值），不支持消息头的中间件忽略
+  std::vector<std::pair<std::string, std::string>> headers;
+  // 投递完成（成功或失败）后调用，可能在中间件的后台线程中执行
+  PublishCallback callback;
+};
+
+// 发布统计
+struct PublisherStats {
+  uint64_t inFlightMessages = 0;  /// 已入队未确认的消息数
+  uint64_t inFlightBytes = 0;     /// 已入队未确认的字节数
+  uint64_t delivered = 0;         /// 确认成功的消息数
+  uint64_t failed = 0;            /// 投递失败的消息数
+  uint64_t totalLatencyUs = 0;    /// 已确认消息的入队到确认耗时总和
+  // 入队到确认耗时分布
+  utils::HistogramSnapshot deliveryLatencyUs;
+
+  // 中间件自身的统计（Kafka 为 statistics.interval.ms 周期上报），未上报时为 0
+  uint64_t statsUpdates = 0;          /// 已收到的统计上报次数
+  uint64_t queueMessages = 0;         /// 客户端队列中的消息数
+  uint64_t queueBytes = 0;            /// 客户端队列中的字节数
+  uint64_t brokerOutbufMessages = 0;  /// 已发往 broker 待确认的消息数
+  int64_t rttAvgUs = 0;               /// broker 往返时间均值，取各 broker 最大值
+  int64_t rttP99Us = 0;
+  int64_t batchSizeAvg = 0;           /// 批次字节数均值，取各主题最大值
+  int64_t batchSizeP99 = 0;
+  int64_t batchCountAvg = 0;          /// 每批消息数均值，取各主题最大值
+
+  // 落盘缓冲（SpillPublisher）统计，未使用时为 0
+  uint64_t spilledMessages = 0;       /// 累计落盘的消息数
+  uint64_t replayedMessages = 0;      /// 累计回放成功的消息数
+  uint64_t spillDropped = 0;          /// 磁盘配额用尽或消息过大而丢弃的消息数
+  uint64_t spillPendingMessages = 0;  /// 磁盘上待回放的消息数
+  uint64_t spillPendingBytes = 0;     /// 磁盘上待回放的字节数
+};
+
 class BasePublisher {
  public:
   virtual ~BasePublisher() = default;
@@ -20,10 +81,93 @@ class BasePublisher {
   virtual bool publish(
       const std::string &topic, const unsigned char *message, const size_t size) = 0;
 
+  bool publish(
+      const std::string &topic,
+      const std::string &message,
+      const PublishOptions &options) {
+    return publish(
+        topic,
+        reinterpret_cast<const unsigned char *>(message.data()),
+        message.size(),
+        options);
+  }
+
+  // 发布消息并转移缓冲区所有权，支持的中间件可免拷贝发送，发送完成后缓冲区归还池
+  virtual bool publish(const std::string &topic, utils::PooledBuffer message) {
+    return publish(topic, message->data(), message->size());
+  }
+
+  // 带选项发布，默认实现忽略 key，同步发布并立即回调
+  virtual bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size,
+      const PublishOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    bool ok = publish(topic, message, size);
+    complete(topic, ok, start, options);
+    return ok;
+  }
+
+  virtual bool publish(
+      const std::string &topic,
+      utils::PooledBuffer message,
+      const PublishOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    bool ok = publish(topic, std::move(message));
+    complete(topic, ok, start, options);
+    return ok;
+  }
+
+  // 异步发布，返回值仅表示是否成功入队，最终结果通过 callback 返回
+  bool publishAsync(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size,
+      PublishCallback callback) {
+    PublishOptions options;
+    options.callback = std::move(callback);
+    return publish(topic, message, size, options);
+  }
+
+  bool publishAsync(
+      const std::string &topic, utils::PooledBuffer message, PublishCallback callback) {
+    PublishOptions options;
+    options.callback = std::move(callback);
+    return publish(topic, std::move(message), options);
+  }
+
+  // 等待已入队消息投递完成，超时返回 false
+  virtual bool flush(int timeoutMs) {
+    return true;
+  }
+
+  virtual PublisherStats stats() const {
+    return PublisherStats();
+  }
+
   // 创建主题/队列，部分中间件支持动态创建
   virtual bool create_topic(
       const std::string &topic,
       const std::map<std::string, std::string> &options = {}) = 0;
+
+ protected:
+  static void complete(
+      const std::string &topic,
+      bool ok,
+      std::chrono::steady_clock::time_point start,
+      const PublishOptions &options) {
+    if (!options.callback) return;
+    PublishResult result;
+    result.ok = ok;
+    result.error = ok ? "" : "publish failed";
+    result.errorCode = ok ? 0 : -1;
+    result.topic = topic;
+    result.latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+    options.callback(result);
+  }
 };
 
-};  // namespace hook_event::publisher
\ No newline at end of file
+};  // namespace hook_event::publisher
@@ -2,19 +2,48 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base_publisher.hpp"
 #include "kafka_publisher.hpp"
+#include "null_publisher.hpp"
+#include "sharded_publisher.hpp"
+#include "spill_publisher.hpp"
 
 namespace hook_event::publisher {
 
-// KafkaPublisher 工厂
+// Publisher 工厂
 class PublisherFactory {
  public:
   static std::shared_ptr<BasePublisher> createKafkaPublisher(
       const KafkaPublisherConfig &config) {
     return std::make_shared<KafkaPublisher>(config);
   }
+
+  // 丢弃所有消息，用于压测
+  static std::shared_ptr<BasePublisher> createNullPublisher() {
+    return std::make_shared<NullPublisher>();
+  }
+
+  // 为 inner 增加落盘缓冲，inner 发布失败时消息写入本地磁盘并在恢复后回放
+  static std::shared_ptr<BasePublisher> createSpillPublisher(
+      std::shared_ptr<BasePublisher> inner, const SpillPublisherConfig &config) {
+    return std::make_shared<SpillPublisher>(std::move(inner), config);
+  }
+
+  // 创建 sharded.shards 个独立的 Kafka producer 并按主题、key 分发消息，
+  // 各 producer 的 client.id 追加分片序号
+  static std::shared_ptr<BasePublisher> createShardedKafkaPublisher(
+      const KafkaPublisherConfig &config, const ShardedPublisherConfig &sharded) {
+    std::vector<std::shared_ptr<BasePublisher>> shards;
+    for (size_t i = 0; i < sharded.shards; ++i) {
+      KafkaPublisherConfig shardConfig = config;
+      if (!shardConfig.clientId.empty())
+        shardConfig.clientId += "-" + std::to_string(i);
+      shards.push_back(std::make_shared<KafkaPublisher>(shardConfig));
+    }
+    return std::make_shared<ShardedPublisher>(std::move(shards), sharded);
+  }
 };
 
 };  // namespace hook_event::publisher
\ No newline at end of file
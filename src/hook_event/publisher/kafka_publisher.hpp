@@ -1,7 +1,12 @@
 #pragma once
+#include <librdkafka/rdkafka.h>
 #include <librdkafka/rdkafkacpp.h>
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
 #include <thread>
@@ -33,6 +38,23 @@ struct KafkaPublisherConfig {
   std::string requestTimeoutMs = "30000";
   // std::string socketTimeoutMs = "30000";
   // std::string sessionTimeoutMs = "10000";
+  // 重试时仍保证同一分区内的顺序
+  std::string enableIdempotence = "false";
+  // librdkafka 统计上报周期，0 表示关闭，结果见 KafkaPublisher::stats
+  std::string statisticsIntervalMs = "5000";
+
+  // 主题配置，如 {"partitioner": "murmur2_random"}
+  std::map<std::string, std::string> topicConfig;
+  // 按主题覆盖 topicConfig
+  std::map<std::string, std::map<std::string, std::string>> topicConfigs;
+
+  std::map<std::string, std::string> topicMap(const std::string &topic) const {
+    std::map<std::string, std::string> m = topicConfig;
+    auto it = topicConfigs.find(topic);
+    if (it == topicConfigs.end()) return m;
+    for (const auto &kv : it->second) m[kv.first] = kv.second;
+    return m;
+  }
 
   std::map<std::string, std::string> toMap() const {
     std::map<std::string, std::string> m;
@@ -55,16 +77,161 @@ struct KafkaPublisherConfig {
     m["message.timeout.ms"] = messageTimeoutMs;
     m["retry.backoff.ms"] = retryBackoffMs;
     m["request.timeout.ms"] = requestTimeoutMs;
+    m["enable.idempotence"] = enableIdempotence;
+    m["statistics.interval.ms"] = statisticsIntervalMs;
     // m["socket.timeout.ms"] = socketTimeoutMs;
     // m["session.timeout.ms"] = sessionTimeoutMs;
     return m;
   }
 };
 
+// 投递报告回调
+// 释放免拷贝发送的缓冲区，汇总在途消息统计，并将最终结果回调给调用方
+class KafkaDeliveryReport : public RdKafka::DeliveryReportCb {
+ public:
+  // 随消息传给 librdkafka 的 msg_opaque，仅在需要时分配
+  struct Pending {
+    utils::PooledBuffer buffer;
+    PublishCallback callback;
+  };
+
+  void dr_cb(RdKafka::Message &message) override {
+    std::unique_ptr<Pending> pending(static_cast<Pending *>(message.msg_opaque()));
+    bool ok = message.err() == RdKafka::ERR_NO_ERROR;
+    int64_t latency = message.latency();
+
+    inFlightMessages.fetch_sub(1);
+    inFlightBytes.fetch_sub(message.len());
+    if (ok) {
+      delivered.fetch_add(1);
+      if (latency > 0) {
+        totalLatencyUs.fetch_add(static_cast<uint64_t>(latency));
+        deliveryLatency.record(static_cast<uint64_t>(latency));
+      }
+    } else {
+      failed.fetch_add(1);
+    }
+
+    if (!pending || !pending->callback) return;
+    PublishResult result;
+    result.ok = ok;
+    result.errorCode = static_cast<int>(message.err());
+    result.error = ok ? "" : message.errstr();
+    result.topic = message.topic_name();
+    result.partition = message.partition();
+    result.offset = message.offset();
+    result.latencyUs = latency;
+    try {
+      pending->callback(result);
+    } catch (const std::exception &ex) {
+      std::cerr << "Delivery callback failed: " << ex.what() << std::endl;
+    }
+  }
+
+  PublisherStats stats() const {
+    PublisherStats stats;
+    stats.inFlightMessages = inFlightMessages.load();
+    stats.inFlightBytes = inFlightBytes.load();
+    stats.delivered = delivered.load();
+    stats.failed = failed.load();
+    stats.totalLatencyUs = totalLatencyUs.load();
+    stats.deliveryLatencyUs = deliveryLatency.snapshot();
+    return stats;
+  }
+
+  std::atomic<uint64_t> inFlightMessages{0};
+  std::atomic<uint64_t> inFlightBytes{0};
+  std::atomic<uint64_t> delivered{0};
+  std::atomic<uint64_t> failed{0};
+  std::atomic<uint64_t> totalLatencyUs{0};
+  utils::Histogram deliveryLatency;
+};
+
+// librdkafka 事件回调，解析 statistics.interval.ms 周期上报的统计 JSON
+class KafkaStatsEvent : public RdKafka::EventCb {
+ public:
+  void event_cb(RdKafka::Event &event) override {
+    switch (event.type()) {
+      case RdKafka::Event::EVENT_STATS:
+        parse(event.str());
+        break;
+      case RdKafka::Event::EVENT_ERROR:
+        std::cerr << "Kafka error: " << RdKafka::err2str(event.err()) << " "
+                  << event.str() << std::endl;
+        break;
+      default:
+        break;
+    }
+  }
+
+  // 写入 stats 中的中间件统计字段
+  void fill(PublisherStats &stats) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.statsUpdates = latest_.statsUpdates;
+    stats.queueMessages = latest_.queueMessages;
+    stats.queueBytes = latest_.queueBytes;
+    stats.brokerOutbufMessages = latest_.brokerOutbufMessages;
+    stats.rttAvgUs = latest_.rttAvgUs;
+    stats.rttP99Us = latest_.rttP99Us;
+    stats.batchSizeAvg = latest_.batchSizeAvg;
+    stats.batchSizeP99 = latest_.batchSizeP99;
+    stats.batchCountAvg = latest_.batchCountAvg;
+  }
+
+ private:
+  // 字段说明见 librdkafka STATISTICS.md
+  void parse(const std::string &str) {
+    nlohmann::json json = nlohmann::json::parse(str, nullptr, false);
+    if (!json.is_object()) return;
+
+    PublisherStats stats;
+    stats.queueMessages = number(json, "msg_cnt");
+    stats.queueBytes = number(json, "msg_size");
+    auto brokers = json.find("brokers");
+    if (brokers != json.end() && brokers->is_object()) {
+      for (const auto &broker : *brokers) {
+        stats.brokerOutbufMessages += number(broker, "outbuf_msg_cnt");
+        stats.rttAvgUs = std::max(stats.rttAvgUs, number(broker, "rtt", "avg"));
+        stats.rttP99Us = std::max(stats.rttP99Us, number(broker, "rtt", "p99"));
+      }
+    }
+    auto topics = json.find("topics");
+    if (topics != json.end() && topics->is_object()) {
+      for (const auto &topic : *topics) {
+        stats.batchSizeAvg =
+            std::max(stats.batchSizeAvg, number(topic, "batchsize", "avg"));
+        stats.batchSizeP99 =
+            std::max(stats.batchSizeP99, number(topic, "batchsize", "p99"));
+        stats.batchCountAvg =
+            std::max(stats.batchCountAvg, number(topic, "batchcnt", "avg"));
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.statsUpdates = latest_.statsUpdates + 1;
+    latest_ = stats;
+  }
+
+  // json[key] 或 json[key][sub]，不存在时为 0
+  static int64_t number(
+      const nlohmann::json &json, const char *key, const char *sub = nullptr) {
+    if (!json.is_object()) return 0;
+    auto it = json.find(key);
+    if (it == json.end()) return 0;
+    if (sub) return number(*it, sub);
+    return it->is_number() ? it->get<int64_t>() : 0;
+  }
+
+  mutable std::mutex mutex_;
+  PublisherStats latest_;
+};
+
 class KafkaPublisher : public BasePublisher {
  public:
+  using BasePublisher::publish;
+
   KafkaPublisher(KafkaPublisherConfig cfg)
-      : producer_(nullptr), config_(cfg), running_(false) {
+      : running_(false), producer_(nullptr), config_(cfg) {
     start();
   }
   ~KafkaPublisher() override {
@@ -88,28 +255,160 @@ class KafkaPublisher : public BasePublisher {
       const std::string &topic,
       const unsigned char *message,
       const size_t size) override {
-    if (!running_.load() || !producer_) return false;
+    return publish(topic, message, size, PublishOptions());
+  }
 
-    RdKafka::ErrorCode resp = producer_->produce(
+  // 免拷贝发送，缓冲区在投递报告回调中归还
+  bool publish(const std::string &topic, utils::PooledBuffer message) override {
+    return publish(topic, std::move(message), PublishOptions());
+  }
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size,
+      const PublishOptions &options) override {
+    KafkaDeliveryReport::Pending *pending = nullptr;
+    if (options.callback) {
+      pending = new KafkaDeliveryReport::Pending();
+      pending->callback = options.callback;
+    }
+    return produce(
         topic,
-        RdKafka::Topic::PARTITION_UA,
-        RdKafka::Producer::RK_MSG_COPY,
         const_cast<unsigned char *>(message),
         size,
-        nullptr,
-        0,
-        0,
-        nullptr,
-        nullptr);
+        RdKafka::Producer::RK_MSG_COPY,
+        pending,
+        options);
+  }
+
+  bool publish(
+      const std::string &topic,
+      utils::PooledBuffer message,
+      const PublishOptions &options) override {
+    auto *pending = new KafkaDeliveryReport::Pending();
+    pending->buffer = std::move(message);
+    pending->callback = options.callback;
+    utils::ByteBuffer &buffer = *pending->buffer;
+    return produce(topic, buffer.data(), buffer.size(), 0, pending, options);
+  }
+
+  bool flush(int timeoutMs) override {
+    if (!producer_) return true;
+    return producer_->flush(timeoutMs) == RdKafka::ERR_NO_ERROR;
+  }
+
+  // 在途消息数及投递结果统计，可用于按 broker 确认情况限流
+  PublisherStats stats() const override {
+    PublisherStats stats = delivery_report_.stats();
+    stats_event_.fill(stats);
+    return stats;
+  }
+
+ private:
+  // pending 为空时 librdkafka 拷贝消息且不回调
+  bool produce(
+      const std::string &topic,
+      unsigned char *payload,
+      size_t size,
+      int flags,
+      KafkaDeliveryReport::Pending *pending,
+      const PublishOptions &options) {
+    RdKafka::ErrorCode resp = RdKafka::ERR__STATE;
+    RdKafka::Topic *handle = running_.load() ? topicHandle(topic) : nullptr;
+    if (handle) {
+      delivery_report_.inFlightMessages.fetch_add(1);
+      delivery_report_.inFlightBytes.fetch_add(size);
+      // 指定 key 时由分区器按 key 选择分区，同一 key 的消息有序
+      const void *key = options.key.empty() ? nullptr : options.key.data();
+      if (options.headers.empty() && !options.timestampMs) {
+        resp = producer_->produce(
+            handle,
+            RdKafka::Topic::PARTITION_UA,
+            flags,
+            payload,
+            size,
+            key,
+            options.key.size(),
+            pending);
+      } else {
+        // C++ 接口带时间戳或消息头时只能按主题名发送，改用 C 接口沿用缓存的主题句柄；
+        // 成功时 headers 由 librdkafka 释放。RK_MSG_* 与 RD_KAFKA_MSG_F_* 取值相同
+        rd_kafka_headers_t *headers = nullptr;
+        if (!options.headers.empty()) {
+          headers = rd_kafka_headers_new(options.headers.size());
+          for (const auto &header : options.headers) {
+            rd_kafka_header_add(
+                headers,
+                header.first.data(),
+                static_cast<ssize_t>(header.first.size()),
+                header.second.data(),
+                static_cast<ssize_t>(header.second.size()));
+          }
+        }
+        resp = static_cast<RdKafka::ErrorCode>(rd_kafka_producev(
+            producer_->c_ptr(),
+            RD_KAFKA_V_RKT(handle->c_ptr()),
+            RD_KAFKA_V_PARTITION(RD_KAFKA_PARTITION_UA),
+            RD_KAFKA_V_MSGFLAGS(flags),
+            RD_KAFKA_V_VALUE(payload, size),
+            RD_KAFKA_V_KEY(key, options.key.size()),
+            RD_KAFKA_V_TIMESTAMP(options.timestampMs),
+            RD_KAFKA_V_HEADERS(headers),
+            RD_KAFKA_V_OPAQUE(pending),
+            RD_KAFKA_V_END));
+        if (resp != RdKafka::ERR_NO_ERROR && headers) rd_kafka_headers_destroy(headers);
+      }
+      if (resp == RdKafka::ERR_NO_ERROR) return true;
 
-    if (resp != RdKafka::ERR_NO_ERROR) {
+      delivery_report_.inFlightMessages.fetch_sub(1);
+      delivery_report_.inFlightBytes.fetch_sub(size);
       std::cerr << "Produce failed: " << RdKafka::err2str(resp) << std::endl;
-      return false;
+    } else if (running_.load()) {
+      resp = RdKafka::ERR__UNKNOWN_TOPIC;
+    }
+
+    // 入队失败同样视为最终结果
+    delivery_report_.failed.fetch_add(1);
+    std::unique_ptr<KafkaDeliveryReport::Pending> guard(pending);
+    if (options.callback) {
+      PublishResult result;
+      result.errorCode = static_cast<int>(resp);
+      result.error = RdKafka::err2str(resp);
+      result.topic = topic;
+      options.callback(result);
     }
-    return true;
+    return false;
   }
 
  private:
+  // 返回缓存的主题句柄，首次使用时按主题配置创建
+  RdKafka::Topic *topicHandle(const std::string &topic) {
+    std::lock_guard<std::mutex> lock(topics_mutex_);
+    auto it = topics_.find(topic);
+    if (it != topics_.end()) return it->second.get();
+
+    std::string errstr;
+    RdKafka::Topic *handle = createTopic(topic, errstr);
+    if (!handle) {
+      std::cerr << "Failed to create topic " << topic << ": " << errstr << std::endl;
+      return nullptr;
+    }
+    topics_[topic].reset(handle);
+    return handle;
+  }
+
+  RdKafka::Topic *createTopic(const std::string &topic, std::string &errstr) {
+    if (!producer_) return nullptr;
+    std::unique_ptr<RdKafka::Conf> conf(
+        RdKafka::Conf::create(RdKafka::Conf::CONF_TOPIC));
+    for (const auto &kv : config_.topicMap(topic)) {
+      if (conf->set(kv.first, kv.second, errstr) != RdKafka::Conf::CONF_OK)
+        return nullptr;
+    }
+    return RdKafka::Topic::create(producer_, topic, conf.get(), errstr);
+  }
+
   // config: {"bootstrap.servers": "host1:9092,host2:9092"}
   void start() {
     if (running_.load()) return;
@@ -128,6 +427,12 @@ class KafkaPublisher : public BasePublisher {
         throw std::runtime_error(errstr);
       }
     }
+    if (conf->set("dr_cb", &delivery_report_, errstr) != RdKafka::Conf::CONF_OK ||
+        conf->set("event_cb", &stats_event_, errstr) != RdKafka::Conf::CONF_OK) {
+      std::cerr << "Kafka config error: " << errstr << std::endl;
+      running_.store(false);
+      throw std::runtime_error(errstr);
+    }
 
     producer_ = RdKafka::Producer::create(conf.get(), errstr);
     if (!producer_) {
@@ -136,6 +441,20 @@ class KafkaPublisher : public BasePublisher {
       throw std::runtime_error(errstr);
     }
 
+    // 单独配置的主题预先创建，配置错误在构造时暴露
+    for (const auto &kv : config_.topicConfigs) {
+      RdKafka::Topic *handle = createTopic(kv.first, errstr);
+      if (!handle) {
+        std::cerr << "Kafka topic config error: " << errstr << std::endl;
+        running_.store(false);
+        topics_.clear();
+        delete producer_;
+        producer_ = nullptr;
+        throw std::runtime_error(errstr);
+      }
+      topics_[kv.first].reset(handle);
+    }
+
     thread_ = std::thread([this]() {
       while (running_.load()) {
         producer_->poll(100);  // 每100ms poll一次
@@ -151,6 +470,12 @@ class KafkaPublisher : public BasePublisher {
 
     if (producer_) {
       producer_->flush(5000);
+      // 丢弃未投递的消息，触发投递报告以释放缓冲区
+      producer_->purge(
+          RdKafka::Producer::PURGE_QUEUE | RdKafka::Producer::PURGE_INFLIGHT);
+      producer_->poll(0);
+      // 主题句柄须先于 producer 释放
+      topics_.clear();
       delete producer_;
       producer_ = nullptr;
     }
@@ -161,7 +486,10 @@ class KafkaPublisher : public BasePublisher {
   std::thread thread_;
   RdKafka::Producer *producer_;
   KafkaPublisherConfig config_;
-  std::string topic_;
+  KafkaDeliveryReport delivery_report_;
+  KafkaStatsEvent stats_event_;
+  std::mutex topics_mutex_;
+  std::map<std::string, std::unique_ptr<RdKafka::Topic>> topics_;
 };
 
 };  // namespace hook_event::publisher
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "base_publisher.hpp"
+
+namespace hook_event::publisher {
+
+// 丢弃所有消息的发布器，用于不依赖 broker 测量事件管线本身的吞吐和耗时
+// 消息立即视为投递成功，只统计消息数和字节数
+class NullPublisher : public BasePublisher {
+ public:
+  using BasePublisher::publish;
+
+  uint64_t messages() const {
+    return delivered_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t bytes() const {
+    return bytes_.load(std::memory_order_relaxed);
+  }
+
+  bool create_topic(
+      const std::string &topic,
+      const std::map<std::string, std::string> &options = {}) override {
+    return true;
+  }
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size) override {
+    delivered_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(size, std::memory_order_relaxed);
+    return true;
+  }
+
+  PublisherStats stats() const override {
+    PublisherStats stats;
+    stats.delivered = delivered_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  std::atomic<uint64_t> delivered_{0};
+  std::atomic<uint64_t> bytes_{0};
+};
+
+};  // namespace hook_event::publisher
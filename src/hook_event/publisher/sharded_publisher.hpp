@@ -0,0 +1,164 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "base_publisher.hpp"
+
+namespace hook_event::publisher {
+
+struct ShardedPublisherConfig {
+  // 分片数，工厂按此创建内层发布器（如每个分片一个 Kafka producer）
+  size_t shards = 2;
+  // 独占分片的主题，按顺序各占一个分片（0, 1, ...），其余主题共享剩余分片。
+  // 例如将遥测主题设为独占，避免其排在大体积图像消息之后
+  std::vector<std::string> dedicatedTopics;
+};
+
+// 分片发布器，将消息分散到多个内层发布器以利用多核
+// 同一主题、同一 key 的消息总是进入同一分片，保持顺序；
+// 无 key 的消息按主题选择分片，同一主题内保持顺序。
+// 各 Kafka producer 使用相同的分区器，同一 key 仍写入同一分区。
+class ShardedPublisher : public BasePublisher {
+ public:
+  using BasePublisher::publish;
+
+  ShardedPublisher(
+      std::vector<std::shared_ptr<BasePublisher>> shards, ShardedPublisherConfig config)
+      : shards_(std::move(shards)), config_(std::move(config)) {
+    if (shards_.empty()) throw std::runtime_error("sharded publisher needs shards");
+    for (const auto &shard : shards_) {
+      if (!shard) throw std::runtime_error("sharded publisher shard is null");
+    }
+    if (config_.dedicatedTopics.size() >= shards_.size())
+      throw std::runtime_error("sharded publisher needs a shard for other topics");
+  }
+
+  size_t shardCount() const {
+    return shards_.size();
+  }
+
+  // 消息所在的分片
+  size_t shardOf(const std::string &topic, const std::string &key) const {
+    const std::vector<std::string> &dedicated = config_.dedicatedTopics;
+    for (size_t i = 0; i < dedicated.size(); ++i) {
+      if (dedicated[i] == topic) return i;
+    }
+    uint64_t hash = fnv1a(topic.data(), topic.size(), kFnvOffset);
+    if (!key.empty()) hash = fnv1a(key.data(), key.size(), hash ^ 0xff);
+    size_t shared = shards_.size() - dedicated.size();
+    return dedicated.size() + static_cast<size_t>(hash % shared);
+  }
+
+  bool create_topic(
+      const std::string &topic,
+      const std::map<std::string, std::string> &options = {}) override {
+    bool ok = true;
+    for (const auto &shard : shards_) ok = shard->create_topic(topic, options) && ok;
+    return ok;
+  }
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size) override {
+    return shards_[shardOf(topic, std::string())]->publish(topic, message, size);
+  }
+
+  bool publish(const std::string &topic, utils::PooledBuffer message) override {
+    return shards_[shardOf(topic, std::string())]->publish(topic, std::move(message));
+  }
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size,
+      const PublishOptions &options) override {
+    return shards_[shardOf(topic, options.key)]->publish(topic, message, size, options);
+  }
+
+  bool publish(
+      const std::string &topic,
+      utils::PooledBuffer message,
+      const PublishOptions &options) override {
+    return shards_[shardOf(topic, options.key)]->publish(
+        topic, std::move(message), options);
+  }
+
+  // 各分片共用同一截止时间
+  bool flush(int timeoutMs) override {
+    auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    bool ok = true;
+    for (const auto &shard : shards_) {
+      auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+          deadline - std::chrono::steady_clock::now());
+      ok = shard->flush(std::max(0, static_cast<int>(remaining.count()))) && ok;
+    }
+    return ok;
+  }
+
+  // 计数累加；耗时、批次等分布取各分片最大值
+  PublisherStats stats() const override {
+    PublisherStats total;
+    for (const auto &shard : shards_) {
+      PublisherStats s = shard->stats();
+      total.inFlightMessages += s.inFlightMessages;
+      total.inFlightBytes += s.inFlightBytes;
+      total.delivered += s.delivered;
+      total.failed += s.failed;
+      total.totalLatencyUs += s.totalLatencyUs;
+      merge(total.deliveryLatencyUs, s.deliveryLatencyUs);
+      total.statsUpdates += s.statsUpdates;
+      total.queueMessages += s.queueMessages;
+      total.queueBytes += s.queueBytes;
+      total.brokerOutbufMessages += s.brokerOutbufMessages;
+      total.rttAvgUs = std::max(total.rttAvgUs, s.rttAvgUs);
+      total.rttP99Us = std::max(total.rttP99Us, s.rttP99Us);
+      total.batchSizeAvg = std::max(total.batchSizeAvg, s.batchSizeAvg);
+      total.batchSizeP99 = std::max(total.batchSizeP99, s.batchSizeP99);
+      total.batchCountAvg = std::max(total.batchCountAvg, s.batchCountAvg);
+      total.spilledMessages += s.spilledMessages;
+      total.replayedMessages += s.replayedMessages;
+      total.spillDropped += s.spillDropped;
+      total.spillPendingMessages += s.spillPendingMessages;
+      total.spillPendingBytes += s.spillPendingBytes;
+    }
+    return total;
+  }
+
+ private:
+  static const uint64_t kFnvOffset = 14695981039346656037ull;
+  static const uint64_t kFnvPrime = 1099511628211ull;
+
+  static uint64_t fnv1a(const char *data, size_t size, uint64_t hash) {
+    for (size_t i = 0; i < size; ++i) {
+      hash ^= static_cast<unsigned char>(data[i]);
+      hash *= kFnvPrime;
+    }
+    return hash;
+  }
+
+  // 分位数无法精确合并，取各分片最大值作为上界
+  static void merge(
+      utils::HistogramSnapshot &total, const utils::HistogramSnapshot &s) {
+    if (!s.count) return;
+    total.min = total.count ? std::min(total.min, s.min) : s.min;
+    total.count += s.count;
+    total.sum += s.sum;
+    total.max = std::max(total.max, s.max);
+    total.p50 = std::max(total.p50, s.p50);
+    total.p90 = std::max(total.p90, s.p90);
+    total.p99 = std::max(total.p99, s.p99);
+    total.p999 = std::max(total.p999, s.p999);
+  }
+
+  std::vector<std::shared_ptr<BasePublisher>> shards_;
+  ShardedPublisherConfig config_;
+};
+
+};  // namespace hook_event::publisher
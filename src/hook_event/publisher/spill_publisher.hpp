@@ -0,0 +1,721 @@
+#pragma once
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../utils/crc32.hpp"
+#include "base_publisher.hpp"
+
+namespace hook_event::publisher {
+
+struct SpillPublisherConfig {
+  // 段文件目录，不存在时创建（仅创建最后一级）
+  std::string directory = "./spill";
+  // 单个段文件大小，单条消息（含主题和 key）须小于该值
+  size_t segmentBytes = 64 << 20;
+  // 段文件数上限（含预分配的空段），磁盘占用不超过 segmentBytes * maxSegments
+  size_t maxSegments = 16;
+  // 内层发布失败后重试回放的间隔
+  int retryIntervalMs = 500;
+};
+
+// 预分配、内存映射的段文件
+// 文件头 32 字节：magic "HKSP"、版本、段序号、已回放位置；
+// 之后为顺序追加的记录：u32 长度、u32 CRC-32、记录体，按 8 字节对齐，长度为 0 表示结束。
+// 记录体：u16 主题长度、u16 key 长度、u32 标志位、i64 时间戳、u16 消息头个数、u16 保留、
+// u32 消息头总长度、主题、key、消息头、消息。
+// 每个消息头：u16 名称长度、u32 值长度、名称、值。
+// 版本 1 的记录体头只有前 8 字节（无时间戳和消息头），仍可读取回放。
+class SpillSegment {
+ public:
+  static const uint32_t kMagic = 0x50534b48;  // "HKSP"
+  static const uint32_t kVersion = 2;
+  static const size_t kHeaderSize = 32;
+  static const size_t kRecordHeaderSize = 8;
+  static const size_t kBodyHeaderSize = 24;
+  static const size_t kFieldHeaderSize = 6;
+  static const uint32_t kFlagCallback = 1;  // 写入时带回调，回调只保存在内存中
+
+  struct Record {
+    const char *topic;
+    size_t topicSize;
+    const char *key;
+    size_t keySize;
+    const unsigned char *headers;
+    size_t headersSize;
+    size_t headerCount;
+    const unsigned char *payload;
+    size_t size;
+    uint32_t flags;
+    int64_t timestampMs;
+    size_t next;  // 下一条记录的位置
+  };
+
+  ~SpillSegment() {
+    close();
+  }
+
+  // 新建并预分配段文件，失败返回空
+  static std::unique_ptr<SpillSegment> create(const std::string &path, size_t size) {
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      std::cerr << "Failed to create spill segment " << path << ": "
+                << std::strerror(errno) << std::endl;
+      return nullptr;
+    }
+    // 预先分配磁盘块，避免写入映射内存时因磁盘已满触发 SIGBUS
+    int err = ::posix_fallocate(fd, 0, static_cast<off_t>(size));
+    if (err != 0) {
+      std::cerr << "Failed to allocate spill segment " << path << ": "
+                << std::strerror(err) << std::endl;
+      ::close(fd);
+      ::unlink(path.c_str());
+      return nullptr;
+    }
+    std::unique_ptr<SpillSegment> segment(new SpillSegment(path, fd, size));
+    if (!segment->map()) {
+      segment->remove();
+      return nullptr;
+    }
+    putU32(segment->data_, kMagic);
+    putU32(segment->data_ + 4, kVersion);
+    segment->setReadOffset(kHeaderSize);
+    segment->writeOffset = kHeaderSize;
+    segment->readOffset = kHeaderSize;
+    return segment;
+  }
+
+  // 打开已有段文件并扫描出有效记录的末尾，校验失败的尾部视为未写完
+  static std::unique_ptr<SpillSegment> open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kHeaderSize) {
+      ::close(fd);
+      return nullptr;
+    }
+    std::unique_ptr<SpillSegment> segment(
+        new SpillSegment(path, fd, static_cast<size_t>(st.st_size)));
+    if (!segment->map() || getU32(segment->data_) != kMagic) return nullptr;
+    segment->version_ = getU32(segment->data_ + 4);
+    if (segment->version_ != 1 && segment->version_ != kVersion) return nullptr;
+
+    Record record;
+    size_t end = kHeaderSize;
+    while (segment->read(end, segment->size_, record)) end = record.next;
+    segment->writeOffset = end;
+    size_t stored = segment->storedReadOffset();
+    segment->readOffset = stored < kHeaderSize || stored > end ? end : stored;
+    segment->sealed = true;
+    segment->recovered = true;
+    return segment;
+  }
+
+  // 主题、key 或消息头超出记录格式的长度字段时无法落盘
+  static bool fits(const std::string &topic, const PublishOptions &options) {
+    if (topic.size() > UINT16_MAX || options.key.size() > UINT16_MAX ||
+        options.headers.size() > UINT16_MAX)
+      return false;
+    for (const auto &header : options.headers) {
+      if (header.first.size() > UINT16_MAX || header.second.size() > UINT32_MAX)
+        return false;
+    }
+    return true;
+  }
+
+  static size_t headersSize(const PublishOptions &options) {
+    size_t bytes = 0;
+    for (const auto &header : options.headers)
+      bytes += kFieldHeaderSize + header.first.size() + header.second.size();
+    return bytes;
+  }
+
+  static size_t recordSize(
+      size_t topicSize, const PublishOptions &options, size_t size) {
+    size_t bytes = kRecordHeaderSize + kBodyHeaderSize + topicSize +
+                   options.key.size() + headersSize(options) + size;
+    return (bytes + 7) & ~size_t(7);
+  }
+
+  // 追加一条记录，空间不足时返回 false；options 中的回调不落盘
+  bool append(
+      const std::string &topic,
+      const unsigned char *message,
+      size_t size,
+      const PublishOptions &options,
+      uint32_t flags) {
+    size_t need = recordSize(topic.size(), options, size);
+    if (writeOffset + need + 4 > size_) return false;
+
+    const std::string &key = options.key;
+    size_t headersBytes = headersSize(options);
+    unsigned char *p = data_ + writeOffset;
+    unsigned char *body = p + kRecordHeaderSize;
+    putU16(body, static_cast<uint16_t>(topic.size()));
+    putU16(body + 2, static_cast<uint16_t>(key.size()));
+    putU32(body + 4, flags);
+    putU64(body + 8, static_cast<uint64_t>(options.timestampMs));
+    putU16(body + 16, static_cast<uint16_t>(options.headers.size()));
+    putU16(body + 18, 0);
+    putU32(body + 20, static_cast<uint32_t>(headersBytes));
+    unsigned char *q = body + kBodyHeaderSize;
+    std::memcpy(q, topic.data(), topic.size());
+    q += topic.size();
+    std::memcpy(q, key.data(), key.size());
+    q += key.size();
+    for (const auto &header : options.headers) {
+      putU16(q, static_cast<uint16_t>(header.first.size()));
+      putU32(q + 2, static_cast<uint32_t>(header.second.size()));
+      q += kFieldHeaderSize;
+      std::memcpy(q, header.first.data(), header.first.size());
+      q += header.first.size();
+      std::memcpy(q, header.second.data(), header.second.size());
+      q += header.second.size();
+    }
+    if (size) std::memcpy(q, message, size);
+    q += size;
+
+    size_t bodySize = static_cast<size_t>(q - body);
+    putU32(p + 4, utils::crc32(body, bodySize));
+    putU32(p, static_cast<uint32_t>(bodySize));
+    writeOffset += need;
+    return true;
+  }
+
+  // 读取 offset 处的记录，结束或校验失败返回 false
+  bool read(size_t offset, size_t limit, Record &record) const {
+    size_t bodyHeaderSize = version_ == 1 ? 8 : kBodyHeaderSize;
+    if (offset + kRecordHeaderSize + bodyHeaderSize > limit) return false;
+    const unsigned char *p = data_ + offset;
+    size_t bodySize = getU32(p);
+    if (bodySize < bodyHeaderSize || bodySize > limit - offset - kRecordHeaderSize)
+      return false;
+    const unsigned char *body = p + kRecordHeaderSize;
+    if (utils::crc32(body, bodySize) != getU32(p + 4)) return false;
+
+    record.topicSize = getU16(body);
+    record.keySize = getU16(body + 2);
+    record.flags = getU32(body + 4);
+    record.timestampMs = 0;
+    record.headerCount = 0;
+    record.headersSize = 0;
+    if (version_ != 1) {
+      record.timestampMs = static_cast<int64_t>(getU64(body + 8));
+      record.headerCount = getU16(body + 16);
+      record.headersSize = getU32(body + 20);
+    }
+    size_t fixed = bodyHeaderSize + record.topicSize + record.keySize;
+    if (fixed > bodySize || record.headersSize > bodySize - fixed) return false;
+    record.topic = reinterpret_cast<const char *>(body + bodyHeaderSize);
+    record.key = record.topic + record.topicSize;
+    record.headers = body + fixed;
+    record.payload = record.headers + record.headersSize;
+    record.size = bodySize - fixed - record.headersSize;
+    record.next = offset + ((kRecordHeaderSize + bodySize + 7) & ~size_t(7));
+    return true;
+  }
+
+  // 还原记录中的 key、时间戳和消息头，消息头区不完整时返回 false
+  static bool restore(const Record &record, PublishOptions &options) {
+    options.key.assign(record.key, record.keySize);
+    options.timestampMs = record.timestampMs;
+    options.headers.clear();
+    options.headers.reserve(record.headerCount);
+    const unsigned char *p = record.headers;
+    size_t remaining = record.headersSize;
+    for (size_t i = 0; i < record.headerCount; ++i) {
+      if (remaining < kFieldHeaderSize) return false;
+      size_t nameSize = getU16(p);
+      size_t valueSize = getU32(p + 2);
+      p += kFieldHeaderSize;
+      remaining -= kFieldHeaderSize;
+      if (nameSize > remaining || valueSize > remaining - nameSize) return false;
+      const char *name = reinterpret_cast<const char *>(p);
+      options.headers.emplace_back(
+          std::string(name, nameSize), std::string(name + nameSize, valueSize));
+      p += nameSize + valueSize;
+      remaining -= nameSize + valueSize;
+    }
+    return remaining == 0;
+  }
+
+  uint64_t sequence() const {
+    return getU64(data_ + 8);
+  }
+
+  void setSequence(uint64_t sequence) {
+    putU64(data_ + 8, sequence);
+  }
+
+  // 持久化回放进度，重启后从该位置继续
+  void setReadOffset(size_t offset) {
+    putU64(data_ + 16, offset);
+  }
+
+  const std::string &path() const {
+    return path_;
+  }
+
+  bool rename(const std::string &path) {
+    if (::rename(path_.c_str(), path.c_str()) != 0) return false;
+    path_ = path;
+    return true;
+  }
+
+  // 关闭并删除文件
+  void remove() {
+    close();
+    ::unlink(path_.c_str());
+  }
+
+  size_t writeOffset = 0;
+  size_t readOffset = 0;  // 仅由回放线程读写
+  bool sealed = false;    // 不再追加
+  bool recovered = false;  // 启动时从磁盘恢复，记录的回调已不存在
+
+ private:
+  SpillSegment(const std::string &path, int fd, size_t size)
+      : path_(path), fd_(fd), data_(nullptr), size_(size), version_(kVersion) {}
+
+  bool map() {
+    void *data = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+      std::cerr << "Failed to map spill segment " << path_ << ": "
+                << std::strerror(errno) << std::endl;
+      return false;
+    }
+    data_ = static_cast<unsigned char *>(data);
+    // 只有顺序读写
+    ::madvise(data_, size_, MADV_SEQUENTIAL);
+    return true;
+  }
+
+  void close() {
+    if (data_) ::munmap(data_, size_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr;
+    fd_ = -1;
+  }
+
+  size_t storedReadOffset() const {
+    return static_cast<size_t>(getU64(data_ + 16));
+  }
+
+  static void putU16(unsigned char *p, uint16_t v) {
+    p[0] = static_cast<unsigned char>(v);
+    p[1] = static_cast<unsigned char>(v >> 8);
+  }
+
+  static uint16_t getU16(const unsigned char *p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+  }
+
+  static void putU32(unsigned char *p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+  }
+
+  static uint32_t getU32(const unsigned char *p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 |
+           uint32_t(p[3]) << 24;
+  }
+
+  static void putU64(unsigned char *p, uint64_t v) {
+    putU32(p, static_cast<uint32_t>(v));
+    putU32(p + 4, static_cast<uint32_t>(v >> 32));
+  }
+
+  static uint64_t getU64(const unsigned char *p) {
+    return uint64_t(getU32(p)) | uint64_t(getU32(p + 4)) << 32;
+  }
+
+  std::string path_;
+  int fd_;
+  unsigned char *data_;
+  size_t size_;
+  uint32_t version_;  // 恢复的旧版本段只读
+};
+
+// 落盘缓冲发布器，装饰另一个发布器
+// 内层发布失败（如 librdkafka 队列已满）时将消息追加到本地段文件，由后台线程按顺序回放；
+// 存在待回放的消息时新消息同样落盘，保证顺序。落盘只是写入映射内存，不做磁盘 I/O 等待，
+// 段文件由后台线程预先分配。磁盘配额用尽或消息过大时丢弃消息，计入 spillDropped。
+// 带回调的消息在回放完成后回调；进程重启后恢复的消息不再回调。
+class SpillPublisher : public BasePublisher {
+ public:
+  using BasePublisher::publish;
+
+  SpillPublisher(std::shared_ptr<BasePublisher> inner, SpillPublisherConfig config)
+      : inner_(std::move(inner)), config_(std::move(config)) {
+    if (::mkdir(config_.directory.c_str(), 0755) != 0 && errno != EEXIST)
+      throw std::runtime_error(
+          "failed to create spill directory " + config_.directory + ": " +
+          std::strerror(errno));
+    recover();
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+  }
+
+  ~SpillPublisher() override {
+    stop();
+  }
+
+  bool create_topic(
+      const std::string &topic,
+      const std::map<std::string, std::string> &options = {}) override {
+    return inner_->create_topic(topic, options);
+  }
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size) override {
+    return publish(topic, message, size, PublishOptions());
+  }
+
+  // 缓冲区交给内层后入队失败时无法取回，因此按拷贝方式发布
+  bool publish(const std::string &topic, utils::PooledBuffer message) override {
+    return publish(topic, message->data(), message->size(), PublishOptions());
+  }
+
+  bool publish(
+      const std::string &topic,
+      utils::PooledBuffer message,
+      const PublishOptions &options) override {
+    return publish(topic, message->data(), message->size(), options);
+  }
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size,
+      const PublishOptions &options) override {
+    if (!spilling_.load(std::memory_order_acquire) &&
+        forward(topic, message, size, options))
+      return true;
+    return spill(topic, message, size, options);
+  }
+
+  // 等待落盘消息回放完成，再等待内层发布器投递完成
+  bool flush(int timeoutMs) override {
+    auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (!drained_.wait_until(lock, deadline, [this] { return segments_.empty(); }))
+        return false;
+    }
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    return inner_->flush(std::max(0, static_cast<int>(remaining.count())));
+  }
+
+  PublisherStats stats() const override {
+    PublisherStats stats = inner_->stats();
+    stats.spilledMessages = spilled_.load();
+    stats.replayedMessages = replayed_.load();
+    stats.spillDropped = dropped_.load();
+    stats.spillPendingMessages = pendingMessages_.load();
+    stats.spillPendingBytes = pendingBytes_.load();
+    return stats;
+  }
+
+ private:
+  enum class ReplayState { Progress, Drained, Stalled };
+
+  // 调用内层发布器；入队失败时不触发回调，由落盘后的回放负责回调
+  bool forward(
+      const std::string &topic,
+      const unsigned char *message,
+      size_t size,
+      const PublishOptions &options) {
+    if (!options.callback) return inner_->publish(topic, message, size, options);
+
+    PublishCallback callback = options.callback;
+    PublishOptions wrapped = options;
+    wrapped.callback = [callback](const PublishResult &result) {
+      bool *failed = inlineFailure();
+      if (!result.ok && failed) {
+        *failed = true;
+        return;
+      }
+      callback(result);
+    };
+    bool failed = false;
+    inlineFailure() = &failed;
+    bool ok = inner_->publish(topic, message, size, wrapped);
+    inlineFailure() = nullptr;
+    return ok && !failed;
+  }
+
+  // 当前线程正在同步调用内层发布时指向失败标记
+  static bool *&inlineFailure() {
+    static thread_local bool *failed = nullptr;
+    return failed;
+  }
+
+  bool spill(
+      const std::string &topic,
+      const unsigned char *message,
+      size_t size,
+      const PublishOptions &options) {
+    size_t need = SpillSegment::recordSize(topic.size(), options, size);
+    uint32_t flags = options.callback ? SpillSegment::kFlagCallback : 0;
+    if (SpillSegment::fits(topic, options)) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      SpillSegment *segment = writable(need);
+      if (segment && segment->append(topic, message, size, options, flags)) {
+        if (options.callback) callbacks_.push_back(options.callback);
+        spilling_.store(true, std::memory_order_release);
+        spilled_.fetch_add(1);
+        pendingMessages_.fetch_add(1);
+        pendingBytes_.fetch_add(need);
+        lock.unlock();
+        cv_.notify_one();
+        return true;
+      }
+    }
+
+    dropped_.fetch_add(1);
+    if (options.callback) {
+      PublishResult result;
+      result.errorCode = -1;
+      result.error = "spill full";
+      result.topic = topic;
+      options.callback(result);
+    }
+    return false;
+  }
+
+  // 返回可写入 need 字节的段，需持有 mutex_
+  SpillSegment *writable(size_t need) {
+    if (SpillSegment::kHeaderSize + need + 4 > config_.segmentBytes) return nullptr;
+    SpillSegment *current = segments_.empty() ? nullptr : segments_.back().get();
+    if (current && !current->sealed &&
+        current->writeOffset + need + 4 <= config_.segmentBytes)
+      return current;
+    if (current) current->sealed = true;
+
+    std::unique_ptr<SpillSegment> next = std::move(spare_);
+    if (next) {
+      // 预分配的空段在启用时才确定序号
+      next->setSequence(nextSequence_);
+      if (!next->rename(segmentPath(nextSequence_))) {
+        next->remove();
+        next.reset();
+      }
+    }
+    if (!next && fileCount() < config_.maxSegments) {
+      // 预分配未及时完成时同步创建
+      next = SpillSegment::create(segmentPath(nextSequence_), config_.segmentBytes);
+      if (next) next->setSequence(nextSequence_);
+    }
+    if (!next) return nullptr;
+    ++nextSequence_;
+    segments_.push_back(std::move(next));
+    return segments_.back().get();
+  }
+
+  size_t fileCount() const {
+    return segments_.size() + (spare_ ? 1 : 0) + (creatingSpare_ ? 1 : 0);
+  }
+
+  std::string segmentPath(uint64_t sequence) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu.spill", (unsigned long long)sequence);
+    return config_.directory + "/" + name;
+  }
+
+  std::string sparePath() const {
+    return config_.directory + "/spare.tmp";
+  }
+
+  // 加载上次未回放完的段文件
+  void recover() {
+    std::vector<std::pair<uint64_t, std::string>> files;
+    DIR *dir = ::opendir(config_.directory.c_str());
+    if (!dir)
+      throw std::runtime_error("failed to open spill directory " + config_.directory);
+    while (struct dirent *entry = ::readdir(dir)) {
+      std::string name = entry->d_name;
+      unsigned long long sequence = 0;
+      char suffix[8] = {0};
+      if (name.size() == 26 &&
+          std::sscanf(name.c_str(), "%20llu.%5s", &sequence, suffix) == 2 &&
+          std::strcmp(suffix, "spill") == 0)
+        files.emplace_back(sequence, config_.directory + "/" + name);
+    }
+    ::closedir(dir);
+    ::unlink(sparePath().c_str());
+    std::sort(files.begin(), files.end());
+
+    for (const auto &file : files) {
+      nextSequence_ = std::max(nextSequence_, file.first + 1);
+      std::unique_ptr<SpillSegment> segment = SpillSegment::open(file.second);
+      if (!segment) {
+        std::cerr << "Discard invalid spill segment " << file.second << std::endl;
+        ::unlink(file.second.c_str());
+        continue;
+      }
+      SpillSegment::Record record;
+      size_t offset = segment->readOffset;
+      for (; segment->read(offset, segment->writeOffset, record); offset = record.next) {
+        pendingMessages_.fetch_add(1);
+        pendingBytes_.fetch_add(record.next - offset);
+      }
+      segments_.push_back(std::move(segment));
+    }
+    if (!segments_.empty()) spilling_.store(true);
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+      prepareSpare(lock);
+      ReplayState state = ReplayState::Drained;
+      while (running_ && !segments_.empty()) {
+        state = replayFront(lock);
+        if (state != ReplayState::Progress) break;
+      }
+      if (!running_) break;
+      if (state == ReplayState::Stalled || !spare_) {
+        cv_.wait_for(lock, std::chrono::milliseconds(config_.retryIntervalMs));
+      } else {
+        cv_.wait(lock, [this] { return !running_ || !segments_.empty() || !spare_; });
+      }
+    }
+  }
+
+  // 保持一个预分配的空段，落盘时无需创建文件
+  void prepareSpare(std::unique_lock<std::mutex> &lock) {
+    if (spare_ || fileCount() >= config_.maxSegments) return;
+    creatingSpare_ = true;
+    lock.unlock();
+    std::unique_ptr<SpillSegment> spare =
+        SpillSegment::create(sparePath(), config_.segmentBytes);
+    lock.lock();
+    creatingSpare_ = false;
+    spare_ = std::move(spare);
+  }
+
+  // 回放最早的段，记录的读取和发布在锁外进行
+  ReplayState replayFront(std::unique_lock<std::mutex> &lock) {
+    SpillSegment *segment = segments_.front().get();
+    size_t limit = segment->writeOffset;
+    if (segment->readOffset == limit) {
+      // 已全部回放，删除该段；正在写入的段一并删除，之后的落盘使用新段
+      std::unique_ptr<SpillSegment> done = std::move(segments_.front());
+      segments_.pop_front();
+      bool drained = segments_.empty();
+      if (drained) spilling_.store(false, std::memory_order_release);
+      lock.unlock();
+      done->remove();
+      lock.lock();
+      if (!drained) return ReplayState::Progress;
+      drained_.notify_all();
+      return ReplayState::Drained;
+    }
+
+    bool recovered = segment->recovered;
+    size_t offset = segment->readOffset;
+    ReplayState state = ReplayState::Progress;
+    lock.unlock();
+    SpillSegment::Record record;
+    while (offset < limit) {
+      PublishOptions options;
+      if (!segment->read(offset, limit, record) ||
+          !SpillSegment::restore(record, options)) {
+        std::cerr << "Spill segment corrupted: " << segment->path() << std::endl;
+        offset = limit;
+        break;
+      }
+      bool hasCallback = !recovered && (record.flags & SpillSegment::kFlagCallback);
+      if (hasCallback) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        options.callback = callbacks_.front();
+      }
+      if (!forward(
+              std::string(record.topic, record.topicSize),
+              record.payload,
+              record.size,
+              options)) {
+        state = ReplayState::Stalled;
+        break;
+      }
+      if (hasCallback) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        callbacks_.pop_front();
+      }
+      pendingMessages_.fetch_sub(1);
+      pendingBytes_.fetch_sub(record.next - offset);
+      replayed_.fetch_add(1);
+      offset = record.next;
+      segment->setReadOffset(offset);
+    }
+    lock.lock();
+    segment->readOffset = offset;
+    return state;
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!running_) return;
+      running_ = false;
+    }
+    cv_.notify_all();
+    thread_.join();
+
+    // 未回放的段保留在磁盘上，下次启动时继续回放
+    if (spare_) spare_->remove();
+    spare_.reset();
+    segments_.clear();
+    PublishResult result;
+    result.errorCode = -1;
+    result.error = "spilled to disk, not delivered before shutdown";
+    for (const auto &callback : callbacks_) callback(result);
+    callbacks_.clear();
+  }
+
+ private:
+  std::shared_ptr<BasePublisher> inner_;
+  SpillPublisherConfig config_;
+  std::atomic<bool> spilling_{false};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable drained_;
+  bool running_ = false;
+  std::thread thread_;
+  // 按序号排列，最后一个为当前写入段
+  std::deque<std::unique_ptr<SpillSegment>> segments_;
+  std::unique_ptr<SpillSegment> spare_;
+  bool creatingSpare_ = false;
+  uint64_t nextSequence_ = 0;
+  std::deque<PublishCallback> callbacks_;  // 带回调的落盘消息，按写入顺序
+
+  std::atomic<uint64_t> spilled_{0};
+  std::atomic<uint64_t> replayed_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> pendingMessages_{0};
+  std::atomic<uint64_t> pendingBytes_{0};
+};
+
+};  // namespace hook_event::publisher
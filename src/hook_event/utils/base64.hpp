@@ -1,26 +1,247 @@
 #pragma once
 
-#include <boost/archive/iterators/base64_from_binary.hpp>
-#include <boost/archive/iterators/binary_from_base64.hpp>
-#include <boost/archive/iterators/ostream_iterator.hpp>
-#include <boost/archive/iterators/transform_width.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
 #include <vector>
 
-std::string encode_base64(const std::vector<unsigned char> &input) {
-  using namespace boost::archive::iterators;
-  using base64_enc_iterator = base64_from_binary<
-      transform_width<std::vector<unsigned char>::const_iterator, 6, 8>>;
-
-  std::stringstream os;
-  std::copy(
-      base64_enc_iterator(input.begin()),
-      base64_enc_iterator(input.end()),
-      std::ostream_iterator<char>(os));
-
-  // Add padding if needed
-  size_t num_pad = (3 - input.size() % 3) % 3;
-  for (size_t i = 0; i < num_pad; ++i) {
-    os.put('=');
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HOOK_EVENT_BASE64_X86 1
+#endif
+
+// base64 编解码
+// 编码按 CPU 运行时选择 AVX2 / SSSE3 / 标量实现，输出写入调用方提供的缓冲区。
+
+enum class Base64Impl {
+  Scalar = 0,
+  Ssse3,
+  Avx2,
+};
+
+namespace hook_event::utils::base64_detail {
+
+static const char kEncodeTable[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+inline size_t encodeTail(const unsigned char *in, size_t size, char *out) {
+  char *p = out;
+  for (; size >= 3; size -= 3, in += 3) {
+    uint32_t v = (uint32_t(in[0]) << 16) | (uint32_t(in[1]) << 8) | in[2];
+    p[0] = kEncodeTable[(v >> 18) & 0x3f];
+    p[1] = kEncodeTable[(v >> 12) & 0x3f];
+    p[2] = kEncodeTable[(v >> 6) & 0x3f];
+    p[3] = kEncodeTable[v & 0x3f];
+    p += 4;
+  }
+  if (size == 1) {
+    uint32_t v = uint32_t(in[0]) << 16;
+    p[0] = kEncodeTable[(v >> 18) & 0x3f];
+    p[1] = kEncodeTable[(v >> 12) & 0x3f];
+    p[2] = '=';
+    p[3] = '=';
+    p += 4;
+  } else if (size == 2) {
+    uint32_t v = (uint32_t(in[0]) << 16) | (uint32_t(in[1]) << 8);
+    p[0] = kEncodeTable[(v >> 18) & 0x3f];
+    p[1] = kEncodeTable[(v >> 12) & 0x3f];
+    p[2] = kEncodeTable[(v >> 6) & 0x3f];
+    p[3] = '=';
+    p += 4;
+  }
+  return static_cast<size_t>(p - out);
+}
+
+inline size_t encodeScalar(const unsigned char *in, size_t size, char *out) {
+  return encodeTail(in, size, out);
+}
+
+#ifdef HOOK_EVENT_BASE64_X86
+
+// 每 12 字节输入拆为 16 个 6bit 索引，再映射为 ASCII
+// 参考 W. Muła, D. Lemire, "Faster Base64 Encoding and Decoding using AVX2"
+__attribute__((target("ssse3"))) inline __m128i ssse3Reshuffle(__m128i in) {
+  in = _mm_shuffle_epi8(
+      in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(t1, t3);
+}
+
+__attribute__((target("ssse3"))) inline __m128i ssse3Translate(__m128i in) {
+  // 'A', 'a' - 26, '0' - 52 (x10), '+' - 62, '/' - 63
+  const __m128i lut =
+      _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+  __m128i indices = _mm_subs_epu8(in, _mm_set1_epi8(51));
+  __m128i mask = _mm_cmpgt_epi8(in, _mm_set1_epi8(25));
+  indices = _mm_sub_epi8(indices, mask);
+  return _mm_add_epi8(in, _mm_shuffle_epi8(lut, indices));
+}
+
+__attribute__((target("ssse3"))) inline size_t encodeSsse3(
+    const unsigned char *in, size_t size, char *out) {
+  char *p = out;
+  // 每次读取 16 字节，消费 12 字节
+  while (size >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+    v = ssse3Translate(ssse3Reshuffle(v));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+    in += 12;
+    size -= 12;
+    p += 16;
+  }
+  return static_cast<size_t>(p - out) + encodeTail(in, size, p);
+}
+
+__attribute__((target("avx2"))) inline size_t encodeAvx2(
+    const unsigned char *in, size_t size, char *out) {
+  // clang-format off
+  const __m256i shuffle = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m256i lut = _mm256_setr_epi8(
+      65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0,
+      65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+  // clang-format on
+
+  char *p = out;
+  // 每次读取 28 字节，消费 24 字节，两个 128bit 通道各处理 12 字节
+  while (size >= 28) {
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 12));
+    __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+    v = _mm256_shuffle_epi8(v, shuffle);
+    const __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    v = _mm256_or_si256(t1, t3);
+
+    __m256i indices = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+    __m256i mask = _mm256_cmpgt_epi8(v, _mm256_set1_epi8(25));
+    indices = _mm256_sub_epi8(indices, mask);
+    v = _mm256_add_epi8(v, _mm256_shuffle_epi8(lut, indices));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+    in += 24;
+    size -= 24;
+    p += 32;
+  }
+  return static_cast<size_t>(p - out) + encodeTail(in, size, p);
+}
+
+#endif  // HOOK_EVENT_BASE64_X86
+
+typedef size_t (*EncodeFn)(const unsigned char *, size_t, char *);
+
+inline EncodeFn encoder(Base64Impl impl) {
+#ifdef HOOK_EVENT_BASE64_X86
+  if (impl == Base64Impl::Avx2) return encodeAvx2;
+  if (impl == Base64Impl::Ssse3) return encodeSsse3;
+#endif
+  return encodeScalar;
+}
+
+inline Base64Impl detectImpl() {
+#ifdef HOOK_EVENT_BASE64_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return Base64Impl::Avx2;
+  if (__builtin_cpu_supports("ssse3")) return Base64Impl::Ssse3;
+#endif
+  return Base64Impl::Scalar;
+}
+
+// 非法字符为 -1
+struct DecodeTable {
+  int8_t v[256];
+  DecodeTable() {
+    std::memset(v, -1, sizeof(v));
+    for (int i = 0; i < 64; ++i) v[static_cast<unsigned char>(kEncodeTable[i])] = i;
   }
-  return os.str();
-}
\ No newline at end of file
+};
+
+};  // namespace hook_event::utils::base64_detail
+
+// 当前 CPU 支持的最快实现
+inline Base64Impl base64_best_impl() {
+  static const Base64Impl impl = hook_event::utils::base64_detail::detectImpl();
+  return impl;
+}
+
+inline bool base64_impl_supported(Base64Impl impl) {
+  return static_cast<int>(impl) <= static_cast<int>(base64_best_impl());
+}
+
+inline size_t base64_encoded_size(size_t size) {
+  return 4 * ((size + 2) / 3);
+}
+
+// out 至少 base64_encoded_size(size) 字节，返回写入长度
+inline size_t encode_base64(
+    const unsigned char *input,
+    size_t size,
+    char *out,
+    Base64Impl impl = base64_best_impl()) {
+  return hook_event::utils::base64_detail::encoder(impl)(input, size, out);
+}
+
+// 追加到 out 末尾
+inline void encode_base64(const unsigned char *input, size_t size, std::string &out) {
+  size_t offset = out.size();
+  out.resize(offset + base64_encoded_size(size));
+  encode_base64(input, size, &out[offset]);
+}
+
+inline std::string encode_base64(const std::vector<unsigned char> &input) {
+  std::string out;
+  encode_base64(input.data(), input.size(), out);
+  return out;
+}
+
+// 严格解码，长度须为 4 的倍数，仅末尾允许 '=' 填充
+inline bool decode_base64(
+    const char *input, size_t size, std::vector<unsigned char> &out) {
+  static const hook_event::utils::base64_detail::DecodeTable table;
+  out.clear();
+  if (size % 4 != 0) return false;
+  if (size == 0) return true;
+
+  size_t pad = 0;
+  if (input[size - 1] == '=') pad = input[size - 2] == '=' ? 2 : 1;
+  out.resize(size / 4 * 3 - pad);
+
+  unsigned char *p = out.data();
+  size_t full = pad ? size - 4 : size;
+  for (size_t i = 0; i < full; i += 4) {
+    int a = table.v[static_cast<unsigned char>(input[i])];
+    int b = table.v[static_cast<unsigned char>(input[i + 1])];
+    int c = table.v[static_cast<unsigned char>(input[i + 2])];
+    int d = table.v[static_cast<unsigned char>(input[i + 3])];
+    if ((a | b | c | d) < 0) return false;
+    uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | d;
+    p[0] = static_cast<unsigned char>(v >> 16);
+    p[1] = static_cast<unsigned char>(v >> 8);
+    p[2] = static_cast<unsigned char>(v);
+    p += 3;
+  }
+
+  if (pad) {
+    const char *q = input + full;
+    int a = table.v[static_cast<unsigned char>(q[0])];
+    int b = table.v[static_cast<unsigned char>(q[1])];
+    int c = pad == 2 ? 0 : table.v[static_cast<unsigned char>(q[2])];
+    if ((a | b | c) < 0) return false;
+    uint32_t v = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6);
+    p[0] = static_cast<unsigned char>(v >> 16);
+    if (pad == 1) p[1] = static_cast<unsigned char>(v >> 8);
+  }
+  return true;
+}
+
+inline bool decode_base64(const std::string &input, std::vector<unsigned char> &out) {
+  return decode_base64(input.data(), input.size(), out);
+}
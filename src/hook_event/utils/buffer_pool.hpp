@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hook_event::utils {
+
+// 可增长的字节缓冲区，resize 不做零初始化
+class ByteBuffer {
+ public:
+  ByteBuffer() : size_(0), capacity_(0) {}
+
+  ByteBuffer(const ByteBuffer &) = delete;
+  ByteBuffer &operator=(const ByteBuffer &) = delete;
+
+  unsigned char *data() {
+    return data_.get();
+  }
+
+  const unsigned char *data() const {
+    return data_.get();
+  }
+
+  char *chars() {
+    return reinterpret_cast<char *>(data_.get());
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  void clear() {
+    size_ = 0;
+  }
+
+  // 保留已有内容
+  void reserve(size_t capacity) {
+    if (capacity <= capacity_) return;
+    size_t grown = capacity_ + capacity_ / 2;
+    if (grown > capacity) capacity = grown;
+    std::unique_ptr<unsigned char[]> data(new unsigned char[capacity]);
+    if (size_) std::memcpy(data.get(), data_.get(), size_);
+    data_ = std::move(data);
+    capacity_ = capacity;
+  }
+
+  void resize(size_t size) {
+    reserve(size);
+    size_ = size;
+  }
+
+  void append(const void *data, size_t size) {
+    reserve(size_ + size);
+    if (size) std::memcpy(data_.get() + size_, data, size);
+    size_ += size;
+  }
+
+  void append(const char *str) {
+    append(str, std::strlen(str));
+  }
+
+  // 扩展 size 字节并返回写入位置
+  unsigned char *grow(size_t size) {
+    size_t offset = size_;
+    resize(size_ + size);
+    return data_.get() + offset;
+  }
+
+ private:
+  std::unique_ptr<unsigned char[]> data_;
+  size_t size_;
+  size_t capacity_;
+};
+
+// 缓冲区池
+// acquire 得到的 PooledBuffer 析构时自动归还，池对象先于缓冲区销毁也是安全的。
+class BufferPool {
+  struct State {
+    std::mutex mutex;
+    std::vector<ByteBuffer *> free;
+    size_t maxPooled;
+    size_t maxRetainBytes;
+
+    ~State() {
+      for (auto *buf : free) delete buf;
+    }
+  };
+
+ public:
+  struct Releaser {
+    std::shared_ptr<State> state;
+
+    void operator()(ByteBuffer *buf) const {
+      if (!buf) return;
+      if (state && buf->capacity() <= state->maxRetainBytes) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->free.size() < state->maxPooled) {
+          buf->clear();
+          state->free.push_back(buf);
+          return;
+        }
+      }
+      delete buf;
+    }
+  };
+
+  typedef std::unique_ptr<ByteBuffer, Releaser> Buffer;
+
+  // maxPooled 为池中保留的空闲缓冲区数，超过 maxRetainBytes 的缓冲区不回收
+  BufferPool(size_t maxPooled = 16, size_t maxRetainBytes = 64 << 20)
+      : state_(std::make_shared<State>()) {
+    state_->maxPooled = maxPooled;
+    state_->maxRetainBytes = maxRetainBytes;
+  }
+
+  Buffer acquire(size_t reserve = 0) {
+    ByteBuffer *buf = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      if (!state_->free.empty()) {
+        buf = state_->free.back();
+        state_->free.pop_back();
+      }
+    }
+    if (!buf) buf = new ByteBuffer();
+    buf->reserve(reserve);
+    return Buffer(buf, Releaser{state_});
+  }
+
+  size_t idle() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->free.size();
+  }
+
+ private:
+  std::shared_ptr<State> state_;
+};
+
+typedef BufferPool::Buffer PooledBuffer;
+
+};  // namespace hook_event::utils
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hook_event::utils {
+
+// CRC-32（IEEE 802.3，与 zlib crc32 结果一致），slicing-by-8 查表
+// crc 为上一段的结果，可分段计算
+inline uint32_t crc32(const void *data, size_t size, uint32_t crc = 0) {
+  struct Table {
+    uint32_t t[8][256];
+    Table() {
+      for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        t[0][i] = c;
+      }
+      for (uint32_t i = 0; i < 256; ++i) {
+        for (int k = 1; k < 8; ++k) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+      }
+    }
+  };
+  static const Table table;
+
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  crc = ~crc;
+  while (size >= 8) {
+    uint32_t lo = crc ^ (uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 |
+                         uint32_t(p[3]) << 24);
+    crc = table.t[7][lo & 0xff] ^ table.t[6][(lo >> 8) & 0xff] ^
+          table.t[5][(lo >> 16) & 0xff] ^ table.t[4][lo >> 24] ^ table.t[3][p[4]] ^
+          table.t[2][p[5]] ^ table.t[1][p[6]] ^ table.t[0][p[7]];
+    p += 8;
+    size -= 8;
+  }
+  while (size--) crc = table.t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+
+};  // namespace hook_event::utils
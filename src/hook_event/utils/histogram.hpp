@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace hook_event::utils {
+
+// 直方图快照，数值单位与 record 一致
+struct HistogramSnapshot {
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t min = 0;
+  uint64_t max = 0;
+  uint64_t p50 = 0;
+  uint64_t p90 = 0;
+  uint64_t p99 = 0;
+  uint64_t p999 = 0;
+
+  double mean() const {
+    return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+  }
+};
+
+// 无锁对数-线性直方图（HDR 风格）
+// 小于 32 的值精确记录，更大的值按 2 的幂分段，每段 16 个桶，相对误差不超过 1/16。
+// record 只做一次 relaxed 原子加，可在任意线程调用；快照不保证各字段严格一致。
+class Histogram {
+ public:
+  static const size_t kSubBits = 4;
+  static const size_t kSubCount = 1 << kSubBits;
+  static const size_t kLinear = kSubCount * 2;  // 精确记录的范围
+  static const size_t kMaxExp = 40;              // 超过 2^41 的值记入最后一个桶
+  static const size_t kBucketCount = kLinear + (kMaxExp - kSubBits) * kSubCount;
+
+  Histogram() {
+    reset();
+  }
+
+  Histogram(const Histogram &) = delete;
+  Histogram &operator=(const Histogram &) = delete;
+
+  void record(uint64_t value) {
+    counts_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (value > current &&
+           !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = min_.load(std::memory_order_relaxed);
+    while (value < current &&
+           !min_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  void reset() {
+    for (size_t i = 0; i < kBucketCount; ++i) counts_[i].store(0);
+    count_.store(0);
+    sum_.store(0);
+    max_.store(0);
+    min_.store(UINT64_MAX);
+  }
+
+  uint64_t count() const {
+    return count_.load(std::memory_order_relaxed);
+  }
+
+  HistogramSnapshot snapshot() const {
+    HistogramSnapshot snap;
+    uint64_t counts[kBucketCount];
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      counts[i] = counts_[i].load(std::memory_order_relaxed);
+      total += counts[i];
+    }
+    snap.count = total;
+    if (!total) return snap;
+    snap.sum = sum_.load(std::memory_order_relaxed);
+    snap.min = min_.load(std::memory_order_relaxed);
+    snap.max = max_.load(std::memory_order_relaxed);
+    snap.p50 = percentile(counts, total, 0.5, snap.max);
+    snap.p90 = percentile(counts, total, 0.9, snap.max);
+    snap.p99 = percentile(counts, total, 0.99, snap.max);
+    snap.p999 = percentile(counts, total, 0.999, snap.max);
+    return snap;
+  }
+
+  static size_t bucketOf(uint64_t value) {
+    if (value < kLinear) return static_cast<size_t>(value);
+    size_t exp = 63 - static_cast<size_t>(__builtin_clzll(value));
+    if (exp > kMaxExp) return kBucketCount - 1;
+    size_t sub = static_cast<size_t>(value >> (exp - kSubBits)) & (kSubCount - 1);
+    return kLinear + (exp - kSubBits - 1) * kSubCount + sub;
+  }
+
+  // 桶内最大值
+  static uint64_t bucketHigh(size_t bucket) {
+    if (bucket < kLinear) return bucket;
+    size_t exp = (bucket - kLinear) / kSubCount + kSubBits + 1;
+    uint64_t sub = (bucket - kLinear) % kSubCount;
+    uint64_t low = (uint64_t(1) << exp) | (sub << (exp - kSubBits));
+    return low + (uint64_t(1) << (exp - kSubBits)) - 1;
+  }
+
+ private:
+  static uint64_t percentile(
+      const uint64_t *counts, uint64_t total, double q, uint64_t max) {
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total) + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        uint64_t high = bucketHigh(i);
+        return high < max ? high : max;
+      }
+    }
+    return max;
+  }
+
+  std::atomic<uint64_t> counts_[kBucketCount];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+  std::atomic<uint64_t> min_;
+};
+
+};  // namespace hook_event::utils
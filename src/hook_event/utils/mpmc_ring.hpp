@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace hook_event::utils {
+
+// 有界无锁环形队列，多生产者多消费者
+// 槽位在构造时一次性分配，push/pop 通过回调原地读写槽位，不产生内存分配。
+// 参考 D. Vyukov, "Bounded MPMC queue"
+template <typename T>
+class MpmcRing {
+ public:
+  // capacity 向上取整为 2 的幂
+  explicit MpmcRing(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (size_t i = 0; i < size; ++i)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    enqueuePos_.store(0, std::memory_order_relaxed);
+    dequeuePos_.store(0, std::memory_order_relaxed);
+  }
+
+  MpmcRing(const MpmcRing &) = delete;
+  MpmcRing &operator=(const MpmcRing &) = delete;
+
+  // fill(T &) 写入槽位，队列满时返回 false
+  template <typename Fill>
+  bool tryPush(Fill &&fill) {
+    Cell *cell;
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (dif == 0) {
+        if (enqueuePos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = enqueuePos_.load(std::memory_order_relaxed);
+      }
+    }
+    fill(cell->value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consume(T &) 读取槽位，返回前槽位不会被复用；队列空时返回 false
+  template <typename Consume>
+  bool tryPop(Consume &&consume) {
+    Cell *cell;
+    size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (dif == 0) {
+        if (dequeuePos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = dequeuePos_.load(std::memory_order_relaxed);
+      }
+    }
+    consume(cell->value);
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  // 近似值，仅用于统计
+  size_t size() const {
+    size_t enq = enqueuePos_.load(std::memory_order_relaxed);
+    size_t deq = dequeuePos_.load(std::memory_order_relaxed);
+    return enq > deq ? enq - deq : 0;
+  }
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+  size_t capacity() const {
+    return mask_ + 1;
+  }
+
+  // 遍历所有槽位，用于预分配槽位内的缓冲区，须在使用前调用
+  template <typename Init>
+  void initSlots(Init &&init) {
+    for (size_t i = 0; i <= mask_; ++i) init(cells_[i].value);
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static const size_t kCacheLine = 64;
+
+  // 用填充隔开生产者和消费者的位置，避免伪共享。
+  // 不使用 alignas：C++11 的 new 不保证超出默认对齐的分配
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  char pad0_[kCacheLine];
+  std::atomic<size_t> enqueuePos_;
+  char pad1_[kCacheLine - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> dequeuePos_;
+  char pad2_[kCacheLine - sizeof(std::atomic<size_t>)];
+};
+
+};  // namespace hook_event::utils
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hook_event::utils {
+
+// 引用计数的对象池
+// Ref 可复制，最后一个引用释放时对象归还池中（内容保留，由使用方重置），
+// 复制和归还均不分配内存，适合在线程间传递定长或预留容量的负载。
+// 池对象先于 Ref 销毁也是安全的。
+template <typename T>
+class ObjectPool {
+  struct State;
+
+  struct Node {
+    T value;
+    std::atomic<size_t> refs{0};
+    std::shared_ptr<State> state;
+  };
+
+  struct State {
+    std::mutex mutex;
+    std::vector<Node *> free;
+    size_t maxPooled;
+
+    ~State() {
+      for (auto *node : free) delete node;
+    }
+  };
+
+ public:
+  class Ref {
+   public:
+    Ref() : node_(nullptr) {}
+
+    Ref(const Ref &other) : node_(other.node_) {
+      if (node_) node_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Ref(Ref &&other) : node_(other.node_) {
+      other.node_ = nullptr;
+    }
+
+    Ref &operator=(Ref other) {
+      std::swap(node_, other.node_);
+      return *this;
+    }
+
+    ~Ref() {
+      reset();
+    }
+
+    void reset() {
+      Node *node = node_;
+      node_ = nullptr;
+      if (!node || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+      // 空闲节点不持有 state，避免循环引用
+      std::shared_ptr<State> state = std::move(node->state);
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->free.size() < state->maxPooled) {
+          state->free.push_back(node);
+          return;
+        }
+      }
+      delete node;
+    }
+
+    T &operator*() const {
+      return node_->value;
+    }
+
+    T *operator->() const {
+      return &node_->value;
+    }
+
+    explicit operator bool() const {
+      return node_ != nullptr;
+    }
+
+   private:
+    friend class ObjectPool;
+    explicit Ref(Node *node) : node_(node) {
+      node_->refs.store(1, std::memory_order_relaxed);
+    }
+
+    Node *node_;
+  };
+
+  // maxPooled 为池中保留的空闲对象数
+  explicit ObjectPool(size_t maxPooled = 64) : state_(std::make_shared<State>()) {
+    state_->maxPooled = maxPooled;
+  }
+
+  Ref acquire() {
+    Node *node = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      if (!state_->free.empty()) {
+        node = state_->free.back();
+        state_->free.pop_back();
+      }
+    }
+    if (!node) node = new Node();
+    node->state = state_;
+    return Ref(node);
+  }
+
+  size_t idle() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->free.size();
+  }
+
+ private:
+  std::shared_ptr<State> state_;
+};
+
+};  // namespace hook_event::utils
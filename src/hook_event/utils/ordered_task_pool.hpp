@@ -0,0 +1,146 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hook_event::utils {
+
+// 有序任务池
+// work 在工作线程中并行执行，commit 严格按照 submit 的顺序串行执行。
+// 用于图像编码：编码并行，推送顺序保持不变。
+class OrderedTaskPool {
+ public:
+  // threads == 0 时在调用线程中同步执行
+  // maxPending 为已提交但尚未 commit 的任务上限，超出时 submit 阻塞
+  OrderedTaskPool(size_t threads, size_t maxPending)
+      : maxPending_(maxPending == 0 ? 1 : maxPending), stopping_(false) {
+    for (size_t i = 0; i < threads; ++i)
+      workers_.emplace_back([this] { workerLoop(); });
+  }
+
+  ~OrderedTaskPool() {
+    flush();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    todoCv_.notify_all();
+    for (auto &t : workers_)
+      if (t.joinable()) t.join();
+  }
+
+  OrderedTaskPool(const OrderedTaskPool &) = delete;
+  OrderedTaskPool &operator=(const OrderedTaskPool &) = delete;
+
+  void submit(std::function<void()> work, std::function<void()> commit) {
+    if (workers_.empty()) {
+      if (runWork(work) && commit) commit();
+      return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->work = std::move(work);
+    job->commit = std::move(commit);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCv_.wait(lock, [this] { return unfinished_ < maxPending_; });
+    ++unfinished_;
+    order_.push_back(job);
+    todo_.push_back(job);
+    lock.unlock();
+    todoCv_.notify_one();
+  }
+
+  // 等待所有已提交任务 commit 完成
+  void flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCv_.wait(lock, [this] { return unfinished_ == 0; });
+  }
+
+  size_t threads() const {
+    return workers_.size();
+  }
+
+  size_t pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return unfinished_;
+  }
+
+ private:
+  struct Job {
+    std::function<void()> work;
+    std::function<void()> commit;
+    bool done = false;
+    bool ok = false;
+  };
+
+  static bool runWork(const std::function<void()> &work) {
+    try {
+      if (work) work();
+      return true;
+    } catch (const std::exception &ex) {
+      std::cerr << "Encode task failed: " << ex.what() << std::endl;
+    } catch (...) {
+      std::cerr << "Encode task failed: unknown error" << std::endl;
+    }
+    return false;
+  }
+
+  void workerLoop() {
+    while (true) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        todoCv_.wait(lock, [this] { return stopping_ || !todo_.empty(); });
+        if (todo_.empty()) return;
+        job = todo_.front();
+        todo_.pop_front();
+      }
+
+      bool ok = runWork(job->work);
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      job->done = true;
+      job->ok = ok;
+      // 同一时刻只允许一个线程执行 commit，保证顺序
+      if (committing_) continue;
+      committing_ = true;
+      while (!order_.empty() && order_.front()->done) {
+        auto head = order_.front();
+        order_.pop_front();
+        lock.unlock();
+        if (head->ok && head->commit) {
+          try {
+            head->commit();
+          } catch (const std::exception &ex) {
+            std::cerr << "Commit task failed: " << ex.what() << std::endl;
+          }
+        }
+        lock.lock();
+        --unfinished_;
+        doneCv_.notify_all();
+      }
+      committing_ = false;
+    }
+  }
+
+ private:
+  const size_t maxPending_;
+  mutable std::mutex mutex_;
+  std::condition_variable todoCv_;
+  std::condition_variable doneCv_;
+  std::deque<std::shared_ptr<Job>> todo_;
+  std::deque<std::shared_ptr<Job>> order_;
+  std::vector<std::thread> workers_;
+  size_t unfinished_ = 0;
+  bool committing_ = false;
+  bool stopping_;
+};
+
+};  // namespace hook_event::utils
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cstring>
+#include <iostream>
+
+namespace hook_event::utils {
+
+// 将当前线程绑定到指定 CPU，cpu 小于 0 时不绑定
+inline bool pinCurrentThread(int cpu) {
+  if (cpu < 0) return true;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (err != 0) {
+    std::cerr << "Failed to pin thread to cpu " << cpu << ": " << std::strerror(err)
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+};  // namespace hook_event::utils
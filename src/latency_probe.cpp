@@ -0,0 +1,121 @@
+// 端到端延迟探针：消费 HookEventPublisher 推送的主题，按消息头中的采集时间
+// 统计各事件类型 采集 -> 收到 的延迟，定期输出 p50/p99/p999
+//
+//   latency_probe [broker] [topic,topic_image] [interval_s]
+#include <librdkafka/rdkafkacpp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "hook_event/event/event_clock.hpp"
+#include "hook_event/event/latency_probe.hpp"
+
+using namespace hook_event::event;
+
+namespace {
+
+std::atomic<bool> running(true);
+
+void onSignal(int) {
+  running.store(false);
+}
+
+std::vector<std::string> split(const std::string &value) {
+  std::vector<std::string> parts;
+  std::stringstream stream(value);
+  std::string part;
+  while (std::getline(stream, part, ',')) {
+    if (!part.empty()) parts.push_back(part);
+  }
+  return parts;
+}
+
+// 没有采集时间消息头（timestamps 关闭或旧版本）时按 Kafka 消息时间戳统计，事件名取主题
+void record(LatencyProbe &probe, RdKafka::Message &message, int64_t receivedUs) {
+  LatencyProbe::Headers headers;
+  RdKafka::Headers *raw = message.headers();
+  if (raw) {
+    for (const auto &header : raw->get_all()) {
+      headers.emplace_back(
+          header.key(),
+          std::string(static_cast<const char *>(header.value()), header.value_size()));
+    }
+  }
+  if (probe.record(headers, receivedUs)) return;
+
+  RdKafka::MessageTimestamp timestamp = message.timestamp();
+  if (timestamp.type == RdKafka::MessageTimestamp::MSG_TIMESTAMP_NOT_AVAILABLE) return;
+  probe.record(message.topic_name(), timestamp.timestamp * 1000, 0, receivedUs);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  std::string broker = "localhost:9092";
+  std::string topics = "test,test_image";
+  int intervalS = 10;
+
+  if (argc > 1) broker = argv[1];
+  if (argc > 2) topics = argv[2];
+  if (argc > 3) intervalS = std::max(1, std::atoi(argv[3]));
+
+  std::string errstr;
+  std::unique_ptr<RdKafka::Conf> conf(
+      RdKafka::Conf::create(RdKafka::Conf::CONF_GLOBAL));
+  // 每次启动使用新的消费组，只统计启动后的消息
+  std::string group =
+      "hook-latency-probe-" + std::to_string(event_clock::wallUs() / 1000000);
+  if (conf->set("bootstrap.servers", broker, errstr) != RdKafka::Conf::CONF_OK ||
+      conf->set("group.id", group, errstr) != RdKafka::Conf::CONF_OK ||
+      conf->set("auto.offset.reset", "latest", errstr) != RdKafka::Conf::CONF_OK ||
+      conf->set("enable.auto.commit", "false", errstr) != RdKafka::Conf::CONF_OK) {
+    std::cerr << "Failed to configure consumer: " << errstr << std::endl;
+    return 1;
+  }
+
+  std::unique_ptr<RdKafka::KafkaConsumer> consumer(
+      RdKafka::KafkaConsumer::create(conf.get(), errstr));
+  if (!consumer) {
+    std::cerr << "Failed to create consumer: " << errstr << std::endl;
+    return 1;
+  }
+  RdKafka::ErrorCode err = consumer->subscribe(split(topics));
+  if (err != RdKafka::ERR_NO_ERROR) {
+    std::cerr << "Failed to subscribe: " << RdKafka::err2str(err) << std::endl;
+    return 1;
+  }
+
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+
+  // 每个周期输出并清空，便于观察负载变化
+  LatencyProbe probe;
+  auto nextReport = std::chrono::steady_clock::now() + std::chrono::seconds(intervalS);
+  while (running.load()) {
+    std::unique_ptr<RdKafka::Message> message(consumer->consume(100));
+    int64_t receivedUs = event_clock::wallUs();
+    if (message->err() == RdKafka::ERR_NO_ERROR) {
+      record(probe, *message, receivedUs);
+    } else if (message->err() != RdKafka::ERR__TIMED_OUT) {
+      std::cerr << "Consume failed: " << message->errstr() << std::endl;
+    }
+
+    if (std::chrono::steady_clock::now() >= nextReport) {
+      std::cout << probe.report() << std::endl;
+      probe.reset();
+      nextReport += std::chrono::seconds(intervalS);
+    }
+  }
+
+  std::cout << probe.report() << std::endl;
+  consumer->close();
+  return 0;
+}
@@ -1,17 +1,613 @@
-// #include "watch/publisher/kafka_publisher.hpp"
+// 合成负载发生器：按指定帧率、分辨率、球位置频率和比赛时长驱动 HookEvent，
+// 输出实际吞吐、丢弃事件数及各阶段耗时，用于赛前评估硬件配置
+//
+//   kafka_producer --publisher=null --fps=60 --width=1920 --height=1080
+//   kafka_producer --publisher=kafka --broker=localhost:9092 --source=data
+//
+// 参数见 --help
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include "hook_event/hook_event.hpp"
+
+using namespace hook_event;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+std::atomic<bool> running(true);
+
+void onSignal(int) {
+  running.store(false);
+}
+
+struct LoadOptions {
+  std::string publisher = "kafka";  /// null | kafka
+  std::string broker = "localhost:9092";
+  std::string topic = "test";
+  std::string topicImage = "test_image";
+  double fps = 30;               /// 双目帧率
+  int width = 1280;              /// 图像分辨率
+  int height = 720;
+  double ballRate = 120;         /// 每秒球位置事件数
+  double trackRate = 10;         /// 每秒轨迹事件数
+  double matchSeconds = 10;      /// 每场比赛时长
+  int matches = 1;
+  std::string source = "synthetic";  /// synthetic | data
+  std::string dataDir = "tests/data";
+  std::string imageFormat = "json";  /// json | binary | binary_stereo
+  std::string codec = "png";
+  int level = -1;
+  int quality = 90;
+  double scale = 1.0;
+  size_t encodeThreads = 2;
+  size_t managerThreads = 1;
+  size_t telemetryBatch = 1;
+  int adaptiveBatchMs = 0;  /// 自适应遥测批次的目标延迟，0 表示关闭
+  size_t queueFrames = 8;  /// 排队图像帧数上限，超出时丢弃最旧的帧，0 表示不限制
+  double reportSeconds = 1;
+  bool json = false;  /// 结束时输出 metricsJson
+};
+
+void usage() {
+  LoadOptions d;
+  std::cout
+      << "usage: kafka_producer [--key=value ...]\n"
+      << "  --publisher=null|kafka   (" << d.publisher << ")\n"
+      << "  --broker=HOST:PORT       (" << d.broker << ")\n"
+      << "  --topic=NAME             (" << d.topic << ")\n"
+      << "  --topic-image=NAME       (" << d.topicImage << ")\n"
+      << "  --fps=N                  stereo frames per second (" << d.fps << ")\n"
+      << "  --width=N --height=N     frame size (" << d.width << "x" << d.height
+      << ")\n"
+      << "  --ball-rate=N            ball positions per second (" << d.ballRate << ")\n"
+      << "  --track-rate=N           tracks per second (" << d.trackRate << ")\n"
+      << "  --match-seconds=N        match length (" << d.matchSeconds << ")\n"
+      << "  --matches=N              (" << d.matches << ")\n"
+      << "  --source=synthetic|data  frames generated or looped from --data-dir\n"
+      << "  --data-dir=DIR           (" << d.dataDir << ")\n"
+      << "  --image-format=json|binary|binary_stereo (" << d.imageFormat << ")\n"
+      << "  --codec=png|jpeg|webp|raw|raw_lz4|raw_zstd (" << d.codec << ")\n"
+      << "  --level=N --quality=N --scale=X  image encode settings\n"
+      << "  --encode-threads=N       (" << d.encodeThreads << ")\n"
+      << "  --threads=N              event manager threads (" << d.managerThreads
+      << ")\n"
+      << "  --telemetry-batch=N      (" << d.telemetryBatch << ")\n"
+      << "  --adaptive-batch-ms=N    adapt telemetry batching to N ms latency, 0 off\n"
+      << "  --queue-frames=N         queued frame limit, 0 unbounded (" << d.queueFrames
+      << ")\n"
+      << "  --report-seconds=N       (" << d.reportSeconds << ")\n"
+      << "  --json                   print metrics JSON at the end\n";
+}
+
+bool parseOptions(int argc, char *argv[], LoadOptions &options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") return false;
+    if (arg == "--json") {
+      options.json = true;
+      continue;
+    }
+    size_t eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+      std::cerr << "Invalid argument: " << arg << std::endl;
+      return false;
+    }
+    std::string key = arg.substr(2, eq - 2);
+    std::string value = arg.substr(eq + 1);
+    if (key == "publisher")
+      options.publisher = value;
+    else if (key == "broker")
+      options.broker = value;
+    else if (key == "topic")
+      options.topic = value;
+    else if (key == "topic-image")
+      options.topicImage = value;
+    else if (key == "fps")
+      options.fps = std::atof(value.c_str());
+    else if (key == "width")
+      options.width = std::atoi(value.c_str());
+    else if (key == "height")
+      options.height = std::atoi(value.c_str());
+    else if (key == "ball-rate")
+      options.ballRate = std::atof(value.c_str());
+    else if (key == "track-rate")
+      options.trackRate = std::atof(value.c_str());
+    else if (key == "match-seconds")
+      options.matchSeconds = std::atof(value.c_str());
+    else if (key == "matches")
+      options.matches = std::atoi(value.c_str());
+    else if (key == "source")
+      options.source = value;
+    else if (key == "data-dir")
+      options.dataDir = value;
+    else if (key == "image-format")
+      options.imageFormat = value;
+    else if (key == "codec")
+      options.codec = value;
+    else if (key == "level")
+      options.level = std::atoi(value.c_str());
+    else if (key == "quality")
+      options.quality = std::atoi(value.c_str());
+    else if (key == "scale")
+      options.scale = std::atof(value.c_str());
+    else if (key == "encode-threads")
+      options.encodeThreads = std::strtoul(value.c_str(), nullptr, 10);
+    else if (key == "threads")
+      options.managerThreads = std::strtoul(value.c_str(), nullptr, 10);
+    else if (key == "telemetry-batch")
+      options.telemetryBatch = std::strtoul(value.c_str(), nullptr, 10);
+    else if (key == "adaptive-batch-ms")
+      options.adaptiveBatchMs = std::atoi(value.c_str());
+    else if (key == "queue-frames")
+      options.queueFrames = std::strtoul(value.c_str(), nullptr, 10);
+    else if (key == "report-seconds")
+      options.reportSeconds = std::atof(value.c_str());
+    else {
+      std::cerr << "Unknown option: --" << key << std::endl;
+      return false;
+    }
+  }
+  if (options.fps <= 0 || options.width <= 0 || options.height <= 0 ||
+      options.matchSeconds <= 0 || options.matches <= 0 || options.reportSeconds <= 0) {
+    std::cerr << "fps, size, match length, matches and report interval must be > 0"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// 统计实际推送的消息数和字节数，转发给内层发布器（保留免拷贝路径）
+// 另记录图像主题的消息数及最后一条发布完成的时间
+class MeteredPublisher : public publisher::BasePublisher {
+ public:
+  using BasePublisher::publish;
+
+  MeteredPublisher(
+      std::shared_ptr<publisher::BasePublisher> inner, std::string topicImage)
+      : inner_(std::move(inner)), topic_image_(std::move(topicImage)) {}
+
+  uint64_t messages() const {
+    return messages_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t bytes() const {
+    return bytes_.load(std::memory_order_relaxed);
+  }
+
+  uint64_t imageMessages() const {
+    return image_messages_.load(std::memory_order_acquire);
+  }
+
+  Clock::time_point lastImagePublished() const {
+    Clock::rep ticks = last_image_.load(std::memory_order_acquire);
+    return Clock::time_point(Clock::duration(ticks));
+  }
+
+  bool create_topic(
+      const std::string &topic,
+      const std::map<std::string, std::string> &options = {}) override {
+    return inner_->create_topic(topic, options);
+  }
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size) override {
+    count(size);
+    return published(topic, inner_->publish(topic, message, size));
+  }
+
+  bool publish(const std::string &topic, utils::PooledBuffer message) override {
+    count(message->size());
+    return published(topic, inner_->publish(topic, std::move(message)));
+  }
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size,
+      const publisher::PublishOptions &options) override {
+    count(size);
+    return published(topic, inner_->publish(topic, message, size, options));
+  }
+
+  bool publish(
+      const std::string &topic,
+      utils::PooledBuffer message,
+      const publisher::PublishOptions &options) override {
+    count(message->size());
+    return published(topic, inner_->publish(topic, std::move(message), options));
+  }
+
+  bool flush(int timeoutMs) override {
+    return inner_->flush(timeoutMs);
+  }
+
+  publisher::PublisherStats stats() const override {
+    return inner_->stats();
+  }
+
+ private:
+  void count(size_t size) {
+    messages_.fetch_add(1, std::memory_order_relaxed);
+    bytes_.fetch_add(size, std::memory_order_relaxed);
+  }
+
+  // 图像按提交顺序发布，计数与时间在发布调用返回后更新
+  bool published(const std::string &topic, bool ok) {
+    if (topic == topic_image_) {
+      Clock::rep now = Clock::now().time_since_epoch().count();
+      last_image_.store(now, std::memory_order_release);
+      image_messages_.fetch_add(1, std::memory_order_release);
+    }
+    return ok;
+  }
+
+  std::shared_ptr<publisher::BasePublisher> inner_;
+  const std::string topic_image_;
+  std::atomic<uint64_t> messages_{0};
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<uint64_t> image_messages_{0};
+  std::atomic<Clock::rep> last_image_{0};
+};
+
+// 低频随机纹理放大后作为背景，叠加移动的球，压缩率接近真实画面
+std::vector<cv::Mat> syntheticFrames(const LoadOptions &options, size_t count) {
+  cv::Mat noise(
+      std::max(1, options.height / 16), std::max(1, options.width / 16), CV_8UC3);
+  cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(255));
+  cv::Mat background;
+  cv::resize(noise, background, cv::Size(options.width, options.height));
+
+  std::vector<cv::Mat> frames;
+  int radius = std::max(2, options.height / 60);
+  for (size_t i = 0; i < count; ++i) {
+    cv::Mat frame = background.clone();
+    cv::Point ball(
+        static_cast<int>(options.width * (i + 0.5) / count),
+        static_cast<int>(options.height * (0.2 + 0.6 * (i % 2))));
+    cv::circle(frame, ball, radius, cv::Scalar(255, 255, 255), -1);
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+// 循环使用目录中的图像，缩放到指定分辨率
+std::vector<cv::Mat> dataFrames(const LoadOptions &options) {
+  std::vector<cv::String> paths;
+  cv::glob(options.dataDir + "/*.png", paths);
+  std::sort(paths.begin(), paths.end());
+  std::vector<cv::Mat> frames;
+  for (const auto &path : paths) {
+    cv::Mat image = cv::imread(path);
+    if (image.empty()) continue;
+    cv::Mat frame;
+    cv::resize(image, frame, cv::Size(options.width, options.height));
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+bool imageFormat(const std::string &name, event::ImageWireFormat &format) {
+  if (name == "json")
+    format = event::ImageWireFormat::Json;
+  else if (name == "binary")
+    format = event::ImageWireFormat::Binary;
+  else if (name == "binary_stereo")
+    format = event::ImageWireFormat::BinaryStereo;
+  else
+    return false;
+  return true;
+}
+
+bool imageCodec(const std::string &name, event::ImageCodec &codec) {
+  for (int i = 0; i <= static_cast<int>(event::ImageCodec::RawZstd); ++i) {
+    auto candidate = static_cast<event::ImageCodec>(i);
+    if (name == event::codecName(candidate) && event::codecSupported(candidate)) {
+      codec = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t sum(const uint64_t (&values)[event::kEventTypeCount]) {
+  uint64_t total = 0;
+  for (uint64_t value : values) total += value;
+  return total;
+}
+
+double seconds(Clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+// 产生事件并记录已发出的数量
+class LoadGenerator {
+ public:
+  LoadGenerator(
+      const LoadOptions &options,
+      HookEvent &hook,
+      const MeteredPublisher &metered,
+      std::vector<cv::Mat> frames)
+      : options_(options), hook_(hook), metered_(metered), frames_(std::move(frames)) {
+    track_.resize(32);
+  }
+
+  void run() {
+    start_ = Clock::now();
+    lastReport_ = start_;
+    for (int match = 0; match < options_.matches && running.load(); ++match)
+      runMatch();
+  }
+
+  void report(bool final) {
+    auto now = Clock::now();
+    double elapsed = seconds(now - (final ? start_ : lastReport_));
+    uint64_t messages = metered_.messages() - (final ? 0 : lastMessages_);
+    uint64_t bytes = metered_.bytes() - (final ? 0 : lastBytes_);
+    uint64_t frames = frames_emitted_ - (final ? 0 : lastFrames_);
+    uint64_t balls = balls_emitted_ - (final ? 0 : lastBalls_);
+    event::EventQueueStats queue = hook_.getManager().queueStats();
+    char line[256];
+    std::snprintf(
+        line,
+        sizeof(line),
+        "[%7.1fs] frames %7.1f/s  ball %7.1f/s  messages %8.1f/s  %8.2f MB/s  "
+        "queue %zu  dropped %llu  in-flight %llu",
+        seconds(now - start_),
+        frames / elapsed,
+        balls / elapsed,
+        messages / elapsed,
+        bytes / elapsed / 1e6,
+        queue.events,
+        static_cast<unsigned long long>(sum(queue.dropped)),
+        static_cast<unsigned long long>(hook_.publisher_->stats().inFlightMessages));
+    std::cout << line << std::endl;
+    lastReport_ = now;
+    lastMessages_ = metered_.messages();
+    lastBytes_ = metered_.bytes();
+    lastFrames_ = frames_emitted_;
+    lastBalls_ = balls_emitted_;
+  }
+
+  uint64_t framesEmitted() const {
+    return frames_emitted_;
+  }
+
+  uint64_t ballsEmitted() const {
+    return balls_emitted_;
+  }
+
+  // 发生器跟不上目标帧率而跳过的帧数
+  uint64_t framesMissed() const {
+    return frames_missed_;
+  }
+
+  Clock::time_point started() const {
+    return start_;
+  }
+
+ private:
+  void runMatch() {
+    event::EventManager &manager = hook_.getManager();
+    manager.emit(event::EnumEventType::MatchStart);
+
+    auto matchStart = Clock::now();
+    auto end = matchStart + span(options_.matchSeconds);
+    Clock::duration frameInterval = interval(options_.fps);
+    auto nextFrame = matchStart;
+    auto nextBall = matchStart;
+    auto nextTrack = matchStart;
+    auto nextReport = lastReport_ + span(options_.reportSeconds);
+    while (running.load()) {
+      auto wake = std::min(nextFrame, nextReport);
+      if (options_.ballRate > 0) wake = std::min(wake, nextBall);
+      if (options_.trackRate > 0) wake = std::min(wake, nextTrack);
+      if (wake >= end) break;
+      std::this_thread::sleep_until(wake);
+
+      auto now = Clock::now();
+      if (now >= nextFrame) {
+        const cv::Mat &left = frames_[frame_index_ % frames_.size()];
+        const cv::Mat &right = frames_[(frame_index_ + 1) % frames_.size()];
+        ++frame_index_;
+        manager.emit(event::EnumEventType::CameraStream, left, right);
+        ++frames_emitted_;
+        // 不追赶落后的帧，实际帧率即为可承受的帧率
+        nextFrame += frameInterval;
+        now = Clock::now();
+        while (nextFrame <= now) {
+          nextFrame += frameInterval;
+          ++frames_missed_;
+        }
+      }
+      if (options_.ballRate > 0 && now >= nextBall) {
+        float t = static_cast<float>(seconds(now - matchStart));
+        cv::Point2f left(640 + 400 * std::sin(t), 360 + 200 * std::cos(t));
+        manager.emit(
+            event::EnumEventType::BallPosition, left, left + cv::Point2f(-40, 0));
+        ++balls_emitted_;
+        nextBall = std::max(nextBall + interval(options_.ballRate), now);
+      }
+      if (options_.trackRate > 0 && now >= nextTrack) {
+        for (size_t i = 0; i < track_.size(); ++i)
+          track_[i] = cv::Point3f(static_cast<float>(i), 0.5f * i, 1.0f);
+        manager.emit(event::EnumEventType::RealTrackBallPosition, track_);
+        nextTrack = std::max(nextTrack + interval(options_.trackRate), now);
+      }
+      if (now >= nextReport) {
+        report(false);
+        nextReport += span(options_.reportSeconds);
+      }
+    }
+
+    manager.emit(event::EnumEventType::MatchEnd);
+  }
+
+  static Clock::duration span(double seconds) {
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds));
+  }
+
+  // 频率 hz 对应的间隔
+  static Clock::duration interval(double hz) {
+    return span(1.0 / hz);
+  }
+
+  const LoadOptions &options_;
+  HookEvent &hook_;
+  const MeteredPublisher &metered_;
+  const std::vector<cv::Mat> frames_;
+  std::vector<cv::Point3f> track_;
+  size_t frame_index_ = 0;
+  uint64_t frames_emitted_ = 0;
+  uint64_t balls_emitted_ = 0;
+  uint64_t frames_missed_ = 0;
+  Clock::time_point start_;
+  Clock::time_point lastReport_;
+  uint64_t lastMessages_ = 0;
+  uint64_t lastBytes_ = 0;
+  uint64_t lastFrames_ = 0;
+  uint64_t lastBalls_ = 0;
+};
+
+void printStages(const HookEventMetrics &metrics) {
+  std::printf(
+      "%-10s %-26s %9s %9s %9s %9s %9s\n",
+      "stage",
+      "event",
+      "count",
+      "p50_us",
+      "p99_us",
+      "p999_us",
+      "max_us");
+  for (size_t i = 0; i < event::kPipelineStageCount; ++i) {
+    for (size_t j = 0; j < event::kEventTypeCount; ++j) {
+      const utils::HistogramSnapshot &h = metrics.stages[i][j];
+      if (!h.count) continue;
+      std::printf(
+          "%-10s %-26s %9llu %9llu %9llu %9llu %9llu\n",
+          event::stageName(static_cast<event::PipelineStage>(i)),
+          event::eventName(static_cast<event::EnumEventType>(j)),
+          static_cast<unsigned long long>(h.count),
+          static_cast<unsigned long long>(h.p50),
+          static_cast<unsigned long long>(h.p99),
+          static_cast<unsigned long long>(h.p999),
+          static_cast<unsigned long long>(h.max));
+    }
+  }
+}
+
+}  // namespace
 
 int main(int argc, char *argv[]) {
-  std::string broker = "192.168.1.23:9092";
-  std::string topic = "mlp-logs";
+  LoadOptions options;
+  if (!parseOptions(argc, argv, options)) {
+    usage();
+    return 2;
+  }
+
+  event::HookEventPublisherConfig eventConfig;
+  eventConfig.encodeThreads = options.encodeThreads;
+  eventConfig.telemetryBatchSize = options.telemetryBatch ? options.telemetryBatch : 1;
+  eventConfig.adaptiveBatch.enabled = options.adaptiveBatchMs > 0;
+  eventConfig.adaptiveBatch.targetLatencyMs = options.adaptiveBatchMs;
+  eventConfig.image.level = options.level;
+  eventConfig.image.quality = options.quality;
+  eventConfig.image.scale = options.scale;
+  if (!imageFormat(options.imageFormat, eventConfig.imageFormat) ||
+      !imageCodec(options.codec, eventConfig.image.codec)) {
+    std::cerr << "Unsupported image format or codec: " << options.imageFormat << ", "
+              << options.codec << std::endl;
+    return 2;
+  }
+
+  std::vector<cv::Mat> frames = options.source == "data" ? dataFrames(options)
+                                                         : syntheticFrames(options, 30);
+  if (frames.empty()) {
+    std::cerr << "No frames loaded from " << options.dataDir << std::endl;
+    return 1;
+  }
 
-  if (argc > 1) broker = argv[1];
-  if (argc > 2) topic = argv[2];
+  event::EventManagerConfig managerConfig;
+  managerConfig.threads = options.managerThreads;
+  if (options.queueFrames) {
+    managerConfig.queue.maxFrameBytes =
+        options.queueFrames * 2 * frames[0].total() * frames[0].elemSize();
+  }
 
   try {
-    // KafkaLogProducer producer(broker, topic);
-    // producer.sendLogBatches(5, 10); // 5批，每批10条
+    std::shared_ptr<publisher::BasePublisher> inner;
+    if (options.publisher == "null") {
+      inner = publisher::PublisherFactory::createNullPublisher();
+    } else if (options.publisher == "kafka") {
+      publisher::KafkaPublisherConfig config;
+      config.bootstrapServers = options.broker;
+      inner = publisher::PublisherFactory::createKafkaPublisher(config);
+    } else {
+      std::cerr << "Unknown publisher: " << options.publisher << std::endl;
+      return 2;
+    }
+    auto metered = std::make_shared<MeteredPublisher>(inner, options.topicImage);
+    HookEvent hook(
+        metered, options.topic, options.topicImage, managerConfig, eventConfig);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    LoadGenerator generator(options, hook, *metered, frames);
+    generator.run();
+
+    // 等待事件队列清空（match_end 会等待编码和遥测批次完成），再等待 broker 确认
+    auto deadline = Clock::now() + std::chrono::seconds(30);
+    while (hook.getManager().queueStats().events > 0 && Clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    hook.getManager().stop();
+    bool flushed = hook.publisher_->flush(10000);
+
+    generator.report(true);
+    HookEventMetrics metrics = hook.metrics();
+    // 实际帧率按发布完成的帧计算，截止到最后一帧发布完成（不含之后的 flush），
+    // 队列溢出丢弃或未发布的帧不计入。双目合并为一条消息，否则每帧左右两条
+    bool stereo = eventConfig.imageFormat == event::ImageWireFormat::BinaryStereo;
+    uint64_t perFrame = stereo ? 1 : 2;
+    uint64_t published = metered->imageMessages() / perFrame;
+    double elapsed = seconds(metered->lastImagePublished() - generator.started());
+    std::printf(
+        "target %.1f fps, achieved %.1f fps, %llu frames missed, %llu balls\n",
+        options.fps,
+        published && elapsed > 0 ? published / elapsed : 0.0,
+        static_cast<unsigned long long>(generator.framesMissed()),
+        static_cast<unsigned long long>(generator.ballsEmitted()));
+    std::printf(
+        "%llu messages, %.2f MB, delivered %llu, failed %llu%s\n",
+        static_cast<unsigned long long>(metered->messages()),
+        metered->bytes() / 1e6,
+        static_cast<unsigned long long>(metrics.publisher.delivered),
+        static_cast<unsigned long long>(metrics.publisher.failed),
+        flushed ? "" : " (flush timed out)");
+    for (size_t i = 0; i < event::kEventTypeCount; ++i) {
+      if (!metrics.queue.dropped[i]) continue;
+      std::printf(
+          "dropped %s: %llu\n",
+          event::eventName(static_cast<event::EnumEventType>(i)),
+          static_cast<unsigned long long>(metrics.queue.dropped[i]));
+    }
+    printStages(metrics);
+    if (options.json) std::cout << metrics.toJson() << std::endl;
   } catch (const std::exception &ex) {
     std::cerr << "Error: " << ex.what() << std::endl;
     return 1;
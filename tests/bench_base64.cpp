@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+
+#include <boost/archive/iterators/base64_from_binary.hpp>
+#include <boost/archive/iterators/transform_width.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "hook_event/utils/base64.hpp"
+
+// 旧实现，仅用于对比
+static std::string encode_base64_boost(const std::vector<unsigned char> &input) {
+  using namespace boost::archive::iterators;
+  using base64_enc_iterator = base64_from_binary<
+      transform_width<std::vector<unsigned char>::const_iterator, 6, 8>>;
+
+  std::stringstream os;
+  std::copy(
+      base64_enc_iterator(input.begin()),
+      base64_enc_iterator(input.end()),
+      std::ostream_iterator<char>(os));
+
+  size_t num_pad = (3 - input.size() % 3) % 3;
+  for (size_t i = 0; i < num_pad; ++i) {
+    os.put('=');
+  }
+  return os.str();
+}
+
+static std::vector<unsigned char> makeInput(size_t size) {
+  std::mt19937 rng(1);
+  std::vector<unsigned char> in(size);
+  for (auto &b : in) b = static_cast<unsigned char>(rng());
+  return in;
+}
+
+static void BM_Base64Boost(benchmark::State &state) {
+  auto in = makeInput(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    std::string out = encode_base64_boost(in);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+static void BM_Base64(benchmark::State &state, Base64Impl impl) {
+  if (!base64_impl_supported(impl)) {
+    state.SkipWithError("not supported on this CPU");
+    return;
+  }
+  auto in = makeInput(static_cast<size_t>(state.range(0)));
+  std::string out(base64_encoded_size(in.size()), '\0');
+  for (auto _ : state) {
+    encode_base64(in.data(), in.size(), &out[0], impl);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+static void BM_Base64Decode(benchmark::State &state) {
+  auto in = makeInput(static_cast<size_t>(state.range(0)));
+  std::string encoded = encode_base64(in);
+  std::vector<unsigned char> out;
+  for (auto _ : state) {
+    decode_base64(encoded, out);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+
+// 64KB ~ 4MB，覆盖 1080p PNG 帧的大小
+BENCHMARK(BM_Base64Boost)->Range(64 << 10, 4 << 20);
+BENCHMARK_CAPTURE(BM_Base64, scalar, Base64Impl::Scalar)->Range(64 << 10, 4 << 20);
+BENCHMARK_CAPTURE(BM_Base64, ssse3, Base64Impl::Ssse3)->Range(64 << 10, 4 << 20);
+BENCHMARK_CAPTURE(BM_Base64, avx2, Base64Impl::Avx2)->Range(64 << 10, 4 << 20);
+BENCHMARK(BM_Base64Decode)->Range(64 << 10, 4 << 20);
+
+BENCHMARK_MAIN();
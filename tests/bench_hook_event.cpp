@@ -0,0 +1,338 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <opencv2/opencv.hpp>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hook_event/event/base_event.hpp"
+#include "hook_event/event/event_serializer.hpp"
+#include "hook_event/event/hook_event_publisher.hpp"
+#include "hook_event/event/image_codec.hpp"
+#include "hook_event/publisher/null_publisher.hpp"
+#include "hook_event/utils/base64.hpp"
+
+// emit→编码→发布 全流程性能测试，不依赖 Kafka
+// 机器可读输出：bench_hook_event --benchmark_format=json --benchmark_out=result.json
+
+#ifndef HOOK_EVENT_TEST_DATA
+#define HOOK_EVENT_TEST_DATA "../../tests/data"
+#endif
+
+using namespace hook_event;
+using namespace hook_event::event;
+using namespace hook_event::publisher;
+
+class CountingCallback : public EventMessage {
+ public:
+  std::atomic<uint64_t> count{0};
+  void ballPositionCallback(
+      const cv::Point2f &leftPos, const cv::Point2f &rightPos) override {
+    count.fetch_add(1, std::memory_order_relaxed);
+  }
+  void realTrackBallPositionCallback(const std::vector<cv::Point3f> &pos) override {
+    count.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+static cv::Mat loadFrame(int cols, int rows) {
+  cv::Mat img = cv::imread(std::string(HOOK_EVENT_TEST_DATA) + "/00000.png");
+  if (img.empty()) img = cv::Mat(480, 640, CV_8UC3, cv::Scalar(40, 120, 200));
+  cv::Mat out;
+  cv::resize(img, out, cv::Size(cols, rows));
+  return out;
+}
+
+static std::vector<cv::Point3f> makeTrack(size_t n) {
+  std::vector<cv::Point3f> pos(n);
+  for (size_t i = 0; i < n; ++i)
+    pos[i] = cv::Point3f(0.1f * i, 1.5f + 0.01f * i, 3.25f - 0.02f * i);
+  return pos;
+}
+
+// EventManager 分发吞吐，range(0) 为 EventBackend，range(1) 为 0 球位置 / 1 轨迹。
+// 每次迭代发送一批事件并等待全部分发完成，计时包含分发；批次小于环形队列容量，不会丢弃
+static void BM_EmitDispatch(benchmark::State &state) {
+  EventManagerConfig config;
+  config.backend = static_cast<EventBackend>(state.range(0));
+  EventManager manager(config);
+  auto cb = std::make_shared<CountingCallback>();
+  manager.addCallback(cb);
+  manager.start();
+
+  bool track = state.range(1) != 0;
+  std::vector<cv::Point3f> pos = makeTrack(32);
+  const int batch = 256;
+  uint64_t emitted = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < batch; ++i) {
+      if (track)
+        manager.emit(EnumEventType::RealTrackBallPosition, pos);
+      else
+        manager.emit<BallPositionEvent>(cv::Point2f(1, 2), cv::Point2f(3, 4));
+    }
+    emitted += batch;
+    while (cb->count.load() < emitted) std::this_thread::yield();
+  }
+  manager.stop();
+  state.SetItemsProcessed(static_cast<int64_t>(emitted));
+}
+BENCHMARK(BM_EmitDispatch)
+    ->ArgNames({"backend", "track"})
+    ->Args({0, 0})
+    ->Args({1, 0})
+    ->Args({0, 1})
+    ->Args({1, 1})
+    ->UseRealTime();
+
+// 采集线程复用缓冲区时每帧 clone 与使用帧池的对比，range(0) 为 0 clone / 1 帧池
+static void BM_EmitCameraFrame(benchmark::State &state) {
+  cv::Mat capture = loadFrame(1920, 1080);
+  bool pooled = state.range(0) != 0;
+  EventManagerConfig config;
+  config.framePool.slots = pooled ? 8 : 0;
+  config.framePool.rows = capture.rows;
+  config.framePool.cols = capture.cols;
+  config.framePool.type = capture.type();
+  EventManager manager(config);
+  auto cb = std::make_shared<CountingCallback>();
+  manager.addCallback(cb);
+  manager.start();
+
+  for (auto _ : state) {
+    if (pooled) {
+      FrameSlot slot = manager.acquireFrame();
+      capture.copyTo(slot.left);
+      capture.copyTo(slot.right);
+      manager.emit(std::move(slot));
+    } else {
+      manager.emit<CameraStreamEvent>(capture.clone(), capture.clone());
+    }
+  }
+  manager.stop();
+  state.SetItemsProcessed(int64_t(state.iterations()));
+}
+BENCHMARK(BM_EmitCameraFrame)->ArgNames({"pool"})->Arg(0)->Arg(1)->UseRealTime();
+
+static void BM_EncodeBase64(benchmark::State &state) {
+  std::mt19937 rng(1);
+  std::vector<unsigned char> in(static_cast<size_t>(state.range(0)));
+  for (auto &b : in) b = static_cast<unsigned char>(rng());
+  std::string out(base64_encoded_size(in.size()), '\0');
+  for (auto _ : state) {
+    encode_base64(in.data(), in.size(), &out[0]);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_EncodeBase64)->Arg(64 << 10)->Arg(1 << 20)->Arg(4 << 20);
+
+static void BM_PngEncode(benchmark::State &state) {
+  cv::Mat frame =
+      loadFrame(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+  std::vector<unsigned char> buf;
+  for (auto _ : state) {
+    cv::imencode(".png", frame, buf);
+    benchmark::DoNotOptimize(buf.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * frame.total() * frame.elemSize());
+  state.counters["png_bytes"] = static_cast<double>(buf.size());
+}
+BENCHMARK(BM_PngEncode)
+    ->ArgNames({"cols", "rows"})
+    ->Args({640, 480})
+    ->Args({1280, 720})
+    ->Args({1920, 1080})
+    ->Unit(benchmark::kMillisecond);
+
+// 1080p 单帧各编码耗时与大小，range: ImageCodec, level, 缩放百分比
+static void BM_ImageCodec(benchmark::State &state) {
+  ImageEncodeConfig config;
+  config.codec = static_cast<ImageCodec>(state.range(0));
+  config.level = static_cast<int>(state.range(1));
+  config.scale = static_cast<double>(state.range(2)) / 100;
+  if (!codecSupported(config.codec)) {
+    state.SkipWithError("codec not compiled in");
+    return;
+  }
+  cv::Mat frame = loadFrame(1920, 1080);
+  ImageEncoder encoder(config);
+  std::vector<unsigned char> buf;
+  for (auto _ : state) {
+    encoder.encode(frame, buf);
+    benchmark::DoNotOptimize(buf.data());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * frame.total() * frame.elemSize());
+  state.counters["encoded_bytes"] = static_cast<double>(buf.size());
+}
+
+static void ImageCodecArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"codec", "level", "scale"});
+  b->Args({static_cast<int>(ImageCodec::Png), -1, 100});
+  b->Args({static_cast<int>(ImageCodec::Png), 1, 100});
+  b->Args({static_cast<int>(ImageCodec::Png), 1, 50});
+  b->Args({static_cast<int>(ImageCodec::Jpeg), -1, 100});
+  b->Args({static_cast<int>(ImageCodec::Webp), -1, 100});
+  b->Args({static_cast<int>(ImageCodec::Raw), -1, 100});
+  b->Args({static_cast<int>(ImageCodec::RawLz4), 1, 100});
+  b->Args({static_cast<int>(ImageCodec::RawZstd), 1, 100});
+  b->Args({static_cast<int>(ImageCodec::RawZstd), 3, 100});
+}
+BENCHMARK(BM_ImageCodec)->Apply(ImageCodecArgs)->Unit(benchmark::kMillisecond);
+
+static TelemetryEvent makeEvent(EnumEventType type) {
+  TelemetryEvent event;
+  event.type = type;
+  event.gameId = 12;
+  event.frameId = 34567;
+  event.left = cv::Point2f(123.25f, 456.5f);
+  event.right = cv::Point2f(789.125f, 10.75f);
+  event.position = cv::Point3f(1.5f, 2.25f, 0.125f);
+  if (type == EnumEventType::PredTrackBallPosition ||
+      type == EnumEventType::RealTrackBallPosition)
+    event.positions = makeTrack(32);
+  return event;
+}
+
+// 遥测序列化，range(0) 为 EnumEventType，range(1) 为 TelemetryFormat
+static void BM_TelemetryEncode(benchmark::State &state) {
+  TelemetryEvent event = makeEvent(static_cast<EnumEventType>(state.range(0)));
+  auto serializer = createEventSerializer(static_cast<TelemetryFormat>(state.range(1)));
+  utils::ByteBuffer buf;
+  for (auto _ : state) {
+    buf.clear();
+    serializer->encode(event, buf);
+    benchmark::DoNotOptimize(buf.data());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()));
+  state.counters["msg_bytes"] = static_cast<double>(buf.size());
+}
+
+// 原 nlohmann::json 构建方式，作为对比基线
+static void BM_TelemetryJsonDom(benchmark::State &state) {
+  TelemetryEvent event = makeEvent(static_cast<EnumEventType>(state.range(0)));
+  std::string out;
+  for (auto _ : state) {
+    nlohmann::json msg = {
+        {"event", eventName(event.type)},
+        {"game_id", event.gameId},
+        {"frame_id", event.frameId},
+    };
+    switch (event.type) {
+      case EnumEventType::BallPosition:
+        msg["left"] = {event.left.x, event.left.y};
+        msg["right"] = {event.right.x, event.right.y};
+        break;
+      case EnumEventType::PredTrackBallPosition:
+      case EnumEventType::RealTrackBallPosition: {
+        nlohmann::json arr;
+        for (const auto &p : event.positions) arr.push_back({p.x, p.y, p.z});
+        msg["positions"] = arr;
+        break;
+      }
+      case EnumEventType::ShuttlecockPosition:
+        msg["position"] = {event.position.x, event.position.y, event.position.z};
+        break;
+      default:
+        break;
+    }
+    out = msg.dump();
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()));
+  state.counters["msg_bytes"] = static_cast<double>(out.size());
+}
+
+static void TelemetryArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"event", "format"});
+  for (int type : {EnumEventType::MatchStart,
+                   EnumEventType::BallPosition,
+                   EnumEventType::PredTrackBallPosition,
+                   EnumEventType::ShuttlecockPosition}) {
+    for (int format : {0, 1}) b->Args({type, format});
+  }
+}
+BENCHMARK(BM_TelemetryEncode)->Apply(TelemetryArgs);
+BENCHMARK(BM_TelemetryJsonDom)
+    ->ArgName("event")
+    ->Arg(EnumEventType::MatchStart)
+    ->Arg(EnumEventType::BallPosition)
+    ->Arg(EnumEventType::PredTrackBallPosition)
+    ->Arg(EnumEventType::ShuttlecockPosition);
+
+// 双目帧端到端：cameraStreamCallback → PNG → 封装 → NullPublisher
+// range: cols, rows, 编码线程数, ImageWireFormat
+static void BM_StereoFrames(benchmark::State &state) {
+  cv::Mat frame =
+      loadFrame(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+  auto publisher = std::make_shared<NullPublisher>();
+  HookEventPublisherConfig config;
+  config.encodeThreads = static_cast<size_t>(state.range(2));
+  config.imageFormat = static_cast<ImageWireFormat>(state.range(3));
+  HookEventPublisher event(publisher, "test", "test_image", config);
+  event.matchStartCallback();
+
+  for (auto _ : state) event.cameraStreamCallback(frame, frame);
+  event.flush();
+
+  state.SetItemsProcessed(int64_t(state.iterations()));
+  state.counters["frames_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+  state.counters["bytes_per_frame"] = static_cast<double>(publisher->bytes()) /
+                                      static_cast<double>(state.iterations());
+}
+static void StereoArgs(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"cols", "rows", "threads", "format"});
+  const int sizes[][2] = {{640, 480}, {1280, 720}, {1920, 1080}};
+  for (const auto &size : sizes) {
+    for (int threads : {0, 4}) {
+      b->Args({size[0], size[1], threads, static_cast<int>(ImageWireFormat::Json)});
+      b->Args({size[0], size[1], threads, static_cast<int>(ImageWireFormat::BinaryStereo)});
+    }
+  }
+}
+BENCHMARK(BM_StereoFrames)->Apply(StereoArgs)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// 增量编码：固定背景上有一个移动的方块，range: cols, rows, 关键帧间隔（0 为关闭）
+static void BM_StereoFramesDelta(benchmark::State &state) {
+  cv::Mat background =
+      loadFrame(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+  std::vector<cv::Mat> frames;
+  for (int i = 0; i < 32; ++i) {
+    cv::Mat frame = background.clone();
+    cv::Mat box = frame(cv::Rect((i * 17) % (frame.cols - 64), frame.rows / 3, 64, 64));
+    box.setTo(cv::Scalar(255, 255, 255));
+    frames.push_back(frame);
+  }
+  auto publisher = std::make_shared<NullPublisher>();
+  HookEventPublisherConfig config;
+  config.imageFormat = ImageWireFormat::BinaryStereo;
+  config.delta.keyframeInterval = static_cast<uint32_t>(state.range(2));
+  HookEventPublisher event(publisher, "test", "test_image", config);
+  event.matchStartCallback();
+
+  size_t i = 0;
+  for (auto _ : state) {
+    const cv::Mat &frame = frames[i++ % frames.size()];
+    event.cameraStreamCallback(frame, frame);
+  }
+  event.flush();
+
+  state.SetItemsProcessed(int64_t(state.iterations()));
+  state.counters["bytes_per_frame"] = static_cast<double>(publisher->bytes()) /
+                                      static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_StereoFramesDelta)
+    ->ArgNames({"cols", "rows", "keyframe"})
+    ->Args({1280, 720, 0})
+    ->Args({1280, 720, 30})
+    ->Args({1920, 1080, 0})
+    ->Args({1920, 1080, 30})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
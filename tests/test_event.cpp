@@ -3,11 +3,18 @@
 #include <unistd.h>
 
 #include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "hook_event/event/base_event.hpp"
 #include "hook_event/event/hook_event_publisher.hpp"
+#include "hook_event/event/latency_probe.hpp"
 #include "hook_event/hook_event.hpp"
 #include "hook_event/publisher/factory_publisher.hpp"
 
@@ -55,16 +62,431 @@ TEST(EventManagerTest, MatchStartAndEndCallbacks) {
   manager.stop();
 }
 
+class CountingEventMessage : public EventMessage {
+ public:
+  std::vector<int> frames;
+  std::atomic<int> balls{0};
+  std::atomic<int> tracks{0};
+  std::atomic<int> trackPoints{0};
+  std::atomic<int> shuttlecocks{0};
+  std::atomic<bool> matchEndCalled{false};
+  int sleepMs = 0;
+  void matchEndCallback() override {
+    matchEndCalled = true;
+  }
+  void cameraStreamCallback(
+      const cv::Mat &leftFrame, const cv::Mat &rightFrame) override {
+    frames.push_back(leftFrame.cols);
+  }
+  void ballPositionCallback(
+      const cv::Point2f &leftPos, const cv::Point2f &rightPos) override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+    ++balls;
+  }
+  void predTrackBallPositionCallback(const std::vector<cv::Point3f> &pos) override {
+    ++tracks;
+    trackPoints += static_cast<int>(pos.size());
+  }
+  void realTrackBallPositionCallback(const std::vector<cv::Point3f> &pos) override {
+    ++tracks;
+    trackPoints += static_cast<int>(pos.size());
+  }
+  void shuttlecockPositionCallback(const cv::Point3f &pos) override {
+    ++shuttlecocks;
+  }
+};
+
+TEST(EventManagerTest, TypedEmit) {
+  static_assert(
+      EventTraits<BallPositionEvent>::kType == EnumEventType::BallPosition,
+      "event type mismatch");
+
+  for (auto backend : {EventBackend::Asio, EventBackend::LockFree}) {
+    auto msg = std::make_shared<CountingEventMessage>();
+    EventManagerConfig config;
+    config.backend = backend;
+    EventManager manager(config);
+    manager.addCallback(msg);
+    manager.start();
+
+    cv::Mat frame(4, 8, CV_8UC3);
+    manager.emit<CameraStreamEvent>(frame, frame);
+    manager.emit<BallPositionEvent>(cv::Point2f(1, 2), cv::Point2f(3, 4));
+    TrackPoints points = manager.acquireTrackPoints();
+    points->push_back(cv::Point3f(1, 2, 3));
+    manager.emit<PredTrackBallPositionEvent>(std::move(points));
+    manager.emit<ShuttlecockPositionEvent>(cv::Point3f(1, 2, 3));
+    // 兼容接口
+    manager.emit(EnumEventType::BallPosition, cv::Point2f(1, 2), cv::Point2f(3, 4));
+    EXPECT_THROW(
+        manager.emit(EnumEventType::BallPosition, frame, frame), std::runtime_error);
+    manager.emit<MatchEndEvent>();
+
+    for (int i = 0; i < 100 && !msg->matchEndCalled; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    manager.stop();
+    EXPECT_TRUE(msg->matchEndCalled);
+    EXPECT_EQ(msg->balls.load(), 2);
+    EXPECT_EQ(msg->tracks.load(), 1);
+    EXPECT_EQ(msg->shuttlecocks.load(), 1);
+    ASSERT_EQ(msg->frames.size(), 1);
+    EXPECT_EQ(msg->frames[0], 8);
+  }
+}
+
+TEST(EventManagerTest, TrackEventsReusePointBuffers) {
+  auto msg = std::make_shared<CountingEventMessage>();
+  EventManagerConfig config;
+  config.trackPoolSize = 4;
+  EventManager manager(config);
+  manager.addCallback(msg);
+  manager.start();
+
+  std::vector<cv::Point3f> pos(32, cv::Point3f(1, 2, 3));
+  for (int i = 0; i < 100; ++i) {
+    manager.emit(EnumEventType::RealTrackBallPosition, pos);
+    manager.emit(EnumEventType::ShuttlecockPosition, cv::Point3f(1, 2, 3));
+  }
+  manager.emit(EnumEventType::MatchEnd);
+  for (int i = 0; i < 100 && !msg->matchEndCalled; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  manager.stop();
+
+  EXPECT_EQ(msg->tracks.load(), 100);
+  EXPECT_EQ(msg->trackPoints.load(), 3200);
+  EXPECT_EQ(msg->shuttlecocks.load(), 100);
+  // 缓冲区全部归还，池中最多保留 trackPoolSize 个
+  TrackPoints points = manager.acquireTrackPoints();
+  EXPECT_TRUE(points->empty());
+  EXPECT_GE(points->capacity(), config.ringReservePoints);
+}
+
+TEST(EventManagerTest, BoundedQueueDropPolicies) {
+  auto msg = std::make_shared<CountingEventMessage>();
+  EventManagerConfig config;
+  config.queue.maxEvents = 2;
+  config.queue.policies[EnumEventType::BallPosition] = OverflowPolicy::DropNewest;
+  EventManager manager(config);
+  manager.addCallback(msg);
+
+  // 未启动事件线程，事件全部排队
+  for (int i = 1; i <= 3; ++i)
+    manager.emit(EnumEventType::CameraStream, cv::Mat(1, i, CV_8UC1), cv::Mat());
+  manager.emit(EnumEventType::BallPosition, cv::Point2f(1, 2), cv::Point2f(3, 4));
+  manager.emit(EnumEventType::MatchEnd);
+
+  auto stats = manager.queueStats();
+  EXPECT_EQ(stats.dropped[EnumEventType::CameraStream], 1);
+  EXPECT_EQ(stats.dropped[EnumEventType::BallPosition], 1);
+  EXPECT_EQ(stats.dropped[EnumEventType::MatchEnd], 0);
+  EXPECT_EQ(stats.events, 3);
+  EXPECT_EQ(stats.highWaterEvents, 3);
+  EXPECT_EQ(stats.frameBytes, 5);
+
+  while (manager.poll() != 0) {
+  }
+  // 最早的帧被丢弃，控制事件始终保留
+  EXPECT_EQ(msg->frames, std::vector<int>({2, 3}));
+  EXPECT_EQ(msg->balls, 0);
+  EXPECT_TRUE(msg->matchEndCalled);
+  EXPECT_EQ(manager.queueStats().events, 0);
+}
+
+TEST(EventManagerTest, BoundedQueueBlocks) {
+  auto msg = std::make_shared<CountingEventMessage>();
+  msg->sleepMs = 5;
+  EventManagerConfig config;
+  config.queue.maxEvents = 1;
+  EventManager manager(config);
+  manager.addCallback(msg);
+  manager.start();
+
+  for (int i = 0; i < 10; ++i)
+    manager.emit(EnumEventType::BallPosition, cv::Point2f(1, 2), cv::Point2f(3, 4));
+  while (msg->balls != 10)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  auto stats = manager.queueStats();
+  EXPECT_EQ(stats.totalDropped(), 0);
+  EXPECT_GT(stats.blocked, 0);
+  EXPECT_EQ(stats.highWaterEvents, 1);
+  manager.stop();
+}
+
+// 按回调顺序记录事件，图像回调可阻塞直到 release
+class SequenceEventMessage : public EventMessage {
+ public:
+  std::mutex mutex;
+  std::vector<std::string> events;
+  std::atomic<bool> release{true};
+  std::atomic<bool> inFrame{false};
+  std::atomic<int> ballsDuringFrame{0};
+
+  void matchStartCallback() override {
+    add("start");
+  }
+  void matchEndCallback() override {
+    add("end");
+  }
+  void cameraStreamCallback(
+      const cv::Mat &leftFrame, const cv::Mat &rightFrame) override {
+    inFrame = true;
+    while (!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    add("frame" + std::to_string(leftFrame.cols));
+    inFrame = false;
+  }
+  void ballPositionCallback(
+      const cv::Point2f &leftPos, const cv::Point2f &rightPos) override {
+    if (inFrame) ++ballsDuringFrame;
+    add("ball" + std::to_string(static_cast<int>(leftPos.x)));
+  }
+
+  void add(const std::string &event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push_back(event);
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return events.size();
+  }
+};
+
+TEST(EventManagerTest, StrandsRunStreamsInParallel) {
+  auto msg = std::make_shared<SequenceEventMessage>();
+  EventManagerConfig config;
+  config.threads = 3;
+  config.cpus = {0};
+  EventManager manager(config);
+  manager.addCallback(msg);
+  manager.start();
+
+  // 图像回调阻塞期间球位置回调照常执行
+  msg->release = false;
+  manager.emit(EnumEventType::MatchStart);
+  manager.emit(EnumEventType::CameraStream, cv::Mat(1, 1, CV_8UC1), cv::Mat());
+  for (int i = 0; i < 1000 && !msg->inFrame; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  for (int i = 0; i < 5; ++i)
+    manager.emit(EnumEventType::BallPosition, cv::Point2f(i, 0), cv::Point2f());
+  for (int i = 0; i < 1000 && msg->size() < 6; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_EQ(msg->ballsDuringFrame.load(), 5);
+  msg->release = true;
+
+  manager.emit(EnumEventType::CameraStream, cv::Mat(1, 2, CV_8UC1), cv::Mat());
+  manager.emit(EnumEventType::BallPosition, cv::Point2f(5, 0), cv::Point2f());
+  manager.emit(EnumEventType::MatchEnd);
+  for (int i = 0; i < 1000 && msg->size() < 10; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  manager.stop();
+
+  // 比赛开始/结束与两类事件保持先后顺序，同类事件按 emit 顺序执行
+  ASSERT_EQ(msg->events.size(), 10);
+  EXPECT_EQ(msg->events.front(), "start");
+  EXPECT_EQ(msg->events.back(), "end");
+  std::vector<std::string> frames, balls;
+  for (const auto &event : msg->events) {
+    if (event.compare(0, 5, "frame") == 0) frames.push_back(event);
+    if (event.compare(0, 4, "ball") == 0) balls.push_back(event);
+  }
+  EXPECT_EQ(frames, std::vector<std::string>({"frame1", "frame2"}));
+  ASSERT_EQ(balls.size(), 6);
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(balls[i], "ball" + std::to_string(i));
+}
+
+TEST(EventLanesTest, PriorityWithStarvationLimitAndBarrier) {
+  EventLanes lanes(2);
+  std::string order;
+  auto add = [&](EventLane lane, const std::string &name) {
+    lanes.push(lane, [&order, name] { order += name + " "; });
+  };
+  for (int i = 0; i < 5; ++i) add(EventLane::Media, "m" + std::to_string(i));
+  for (int i = 0; i < 3; ++i) add(EventLane::Telemetry, "t" + std::to_string(i));
+  add(EventLane::Control, "c");
+  add(EventLane::Telemetry, "t3");
+
+  EventLaneStats stats[kEventLaneCount];
+  lanes.fill(stats);
+  EXPECT_EQ(stats[static_cast<size_t>(EventLane::Media)].events, 5);
+  EXPECT_EQ(stats[static_cast<size_t>(EventLane::Telemetry)].highWaterEvents, 4);
+
+  while (lanes.dispatch()) {
+  }
+  // 遥测优先，图像每等待 2 个事件分发一次；控制事件之后的事件不会提前
+  EXPECT_EQ(order, "t0 t1 m0 t2 m1 m2 m3 m4 c t3 ");
+
+  lanes.fill(stats);
+  for (size_t i = 0; i < kEventLaneCount; ++i) EXPECT_EQ(stats[i].events, 0);
+  EXPECT_EQ(stats[static_cast<size_t>(EventLane::Control)].dispatched, 1);
+  EXPECT_EQ(stats[static_cast<size_t>(EventLane::Media)].waitUs.count, 5);
+
+  // 没有等待中的事件时可直接执行，执行结束前其他事件须经过通道
+  EXPECT_TRUE(lanes.tryBypass(EventLane::Media));
+  EXPECT_FALSE(lanes.tryBypass(EventLane::Telemetry));
+  lanes.dispatched(EventLane::Media, EventLanes::Clock::now());
+  lanes.bypassed();
+  EXPECT_TRUE(lanes.tryBypass(EventLane::Telemetry));
+  lanes.dispatched(EventLane::Telemetry, EventLanes::Clock::now());
+  lanes.bypassed();
+  lanes.fill(stats);
+  EXPECT_EQ(stats[static_cast<size_t>(EventLane::Media)].dispatched, 6);
+  EXPECT_EQ(stats[static_cast<size_t>(EventLane::Media)].events, 0);
+}
+
+TEST(EventManagerTest, TelemetryOvertakesQueuedFrames) {
+  auto msg = std::make_shared<SequenceEventMessage>();
+  EventManager manager;
+  manager.addCallback(msg);
+
+  manager.emit(EnumEventType::MatchStart);
+  for (int i = 1; i <= 3; ++i)
+    manager.emit(EnumEventType::CameraStream, cv::Mat(1, i, CV_8UC1), cv::Mat());
+  manager.emit(EnumEventType::BallPosition, cv::Point2f(0, 0), cv::Point2f());
+  manager.emit(EnumEventType::MatchEnd);
+  manager.emit(EnumEventType::BallPosition, cv::Point2f(1, 0), cv::Point2f());
+
+  auto stats = manager.queueStats();
+  EXPECT_EQ(stats.lanes[static_cast<size_t>(EventLane::Media)].events, 3);
+  EXPECT_EQ(stats.lanes[static_cast<size_t>(EventLane::Control)].events, 2);
+  while (manager.poll() != 0) {
+  }
+  EXPECT_EQ(
+      msg->events,
+      std::vector<std::string>(
+          {"start", "ball0", "frame1", "frame2", "frame3", "end", "ball1"}));
+
+  stats = manager.queueStats();
+  EXPECT_EQ(stats.lanes[static_cast<size_t>(EventLane::Telemetry)].dispatched, 2);
+  EXPECT_EQ(stats.lanes[static_cast<size_t>(EventLane::Media)].highWaterEvents, 3);
+  EXPECT_EQ(stats.lanes[static_cast<size_t>(EventLane::Media)].waitUs.count, 3);
+}
+
+// 保留最近一帧的引用，模拟异步编码
+class HoldingEventMessage : public EventMessage {
+ public:
+  std::mutex mutex;
+  cv::Mat last;
+  std::atomic<int> frames{0};
+  void cameraStreamCallback(
+      const cv::Mat &leftFrame, const cv::Mat &rightFrame) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    last = leftFrame;
+    ++frames;
+  }
+};
+
+TEST(EventManagerTest, FramePoolRecyclesSlots) {
+  for (auto backend : {EventBackend::Asio, EventBackend::LockFree}) {
+    auto msg = std::make_shared<HoldingEventMessage>();
+    EventManagerConfig config;
+    config.backend = backend;
+    config.framePool.slots = 2;
+    config.framePool.rows = 4;
+    config.framePool.cols = 8;
+    EventManager manager(config);
+    manager.addCallback(msg);
+
+    FrameSlot a = manager.acquireFrame(0);
+    FrameSlot b = manager.acquireFrame(0);
+    ASSERT_TRUE(a && b);
+    EXPECT_NE(a.left.data, b.left.data);
+    EXPECT_FALSE(manager.acquireFrame(0));
+    std::set<const unsigned char *> buffers = {a.left.data, b.left.data};
+
+    manager.start();
+    a.left.setTo(cv::Scalar::all(1));
+    manager.emit(std::move(a));
+    manager.emit(std::move(b));
+    for (int i = 0; i < 1000 && msg->frames < 2; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // 回调仍持有最后一帧，只有一个槽位空闲
+    EXPECT_EQ(manager.framePool().available(), 1);
+    for (int i = 0; i < 20; ++i) {
+      FrameSlot slot = manager.acquireFrame(1000);
+      ASSERT_TRUE(slot);
+      EXPECT_EQ(buffers.count(slot.left.data), 1);
+      manager.emit(std::move(slot));
+    }
+    for (int i = 0; i < 1000 && msg->frames < 22; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    manager.stop();
+    EXPECT_EQ(msg->frames.load(), 22);
+    {
+      std::lock_guard<std::mutex> lock(msg->mutex);
+      msg->last.release();
+    }
+    EXPECT_EQ(manager.framePool().available(), 2);
+  }
+}
+
+TEST(EventManagerTest, LockFreeBackendDispatch) {
+  auto msg = std::make_shared<CountingEventMessage>();
+  EventManagerConfig config;
+  config.backend = EventBackend::LockFree;
+  config.ringCapacity = 64;
+  EventManager manager(config);
+  manager.addCallback(msg);
+  manager.start();
+  // 运行中不能注册回调
+  EXPECT_THROW(manager.addCallback(msg), std::logic_error);
+
+  // 多生产者
+  std::vector<std::thread> producers;
+  for (int t = 0; t < 4; ++t)
+    producers.emplace_back([&manager] {
+      for (int i = 0; i < 1000; ++i)
+        manager.emit(EnumEventType::BallPosition, cv::Point2f(1, 2), cv::Point2f(3, 4));
+    });
+  for (auto &t : producers) t.join();
+  manager.emit(EnumEventType::CameraStream, cv::Mat(1, 7, CV_8UC1), cv::Mat());
+  manager.emit(EnumEventType::MatchEnd);
+
+  while (!msg->matchEndCalled)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  EXPECT_EQ(msg->balls, 4000);
+  EXPECT_EQ(msg->frames, std::vector<int>({7}));
+  auto stats = manager.queueStats();
+  EXPECT_EQ(stats.emitted[EnumEventType::BallPosition], 4000);
+  EXPECT_EQ(stats.totalDropped(), 0);
+  EXPECT_EQ(stats.frameBytes, 0);
+  manager.stop();
+}
+
+TEST(EventManagerTest, LockFreeBackendOverflow) {
+  auto msg = std::make_shared<CountingEventMessage>();
+  EventManagerConfig config;
+  config.backend = EventBackend::LockFree;
+  config.ringCapacity = 4;
+  config.queue.policies[EnumEventType::BallPosition] = OverflowPolicy::DropNewest;
+  EventManager manager(config);
+  manager.addCallback(msg);
+
+  for (int i = 0; i < 6; ++i)
+    manager.emit(EnumEventType::BallPosition, cv::Point2f(1, 2), cv::Point2f(3, 4));
+  // 队列满时控制事件不丢弃
+  manager.emit(EnumEventType::MatchEnd);
+  EXPECT_EQ(manager.queueStats().dropped[EnumEventType::BallPosition], 2);
+
+  while (manager.poll() != 0) {
+  }
+  EXPECT_EQ(msg->balls, 4);
+  EXPECT_TRUE(msg->matchEndCalled);
+}
+
 // Mock Publisher
 class MockPublisher : public BasePublisher {
  public:
   std::vector<std::pair<std::string, std::string>> published_msgs;
+  std::atomic<size_t> published{0};
   bool publish(
       const std::string &topic,
       const unsigned char *message,
       const size_t size) override {
     published_msgs.emplace_back(
         topic, std::string(reinterpret_cast<const char *>(message), size));
+    ++published;
     return true;
   }
   bool create_topic(
@@ -88,13 +510,733 @@ TEST(HookEventPublisherTest, AllCallbacksPublishMock) {
   event.matchEndCallback();
   event.cameraStreamCallback(imga, imgb);
   event.ballPositionCallback(cv::Point2f(1, 2), cv::Point2f(3, 4));
-  // std::vector<cv::Point3f> pos = {{1, 2, 3}, {4, 5, 6}};
-  // event.predTrackBallPositionCallback(pos);
-  // event.realTrackBallPositionCallback(pos);
-  // event.shuttlecockPositionCallback(cv::Point3f(7, 8, 9));
+  std::vector<cv::Point3f> pos = {{1, 2, 3}, {4, 5, 6}};
+  event.predTrackBallPositionCallback(pos);
+  event.realTrackBallPositionCallback(pos);
+  event.shuttlecockPositionCallback(cv::Point3f(7, 8, 9));
 
   // 检查所有回调都调用了publish
-  EXPECT_EQ(mockPtr->published_msgs.size(), 5);
+  EXPECT_EQ(mockPtr->published_msgs.size(), 8);
+  auto track = nlohmann::json::parse(mockPtr->published_msgs[5].second);
+  EXPECT_EQ(track["event"], "pred_track_ball_position");
+  EXPECT_EQ(track["positions"].size(), 2);
+
+  // 图像消息与 nlohmann::json::dump 输出一致
+  for (size_t i = 2; i < 4; ++i) {
+    const std::string &msg = mockPtr->published_msgs[i].second;
+    auto json = nlohmann::json::parse(msg);
+    EXPECT_EQ(json.dump(), msg);
+    std::vector<unsigned char> png;
+    EXPECT_TRUE(decode_base64(json["data"].get<std::string>(), png));
+  }
+}
+
+TEST(HookEventPublisherTest, EncodePoolKeepsFrameOrder) {
+  auto mock = std::make_shared<MockPublisher>();
+  HookEventPublisherConfig config;
+  config.encodeThreads = 3;
+  config.maxFramesInFlight = 2;
+  HookEventPublisher event(mock, "test", "test_image", config);
+  std::string pwd = getCurrentDir();
+  cv::Mat imga = cv::imread(pwd + "/../../tests/data/00000.png");
+  cv::Mat imgb = cv::imread(pwd + "/../../tests/data/00001.png");
+
+  event.matchStartCallback();
+  for (int i = 0; i < 8; ++i) event.cameraStreamCallback(imga, imgb);
+  event.matchEndCallback();
+
+  // match_start + 8 * 2 帧 + match_end，且图像按 frame_id、左右顺序推送
+  ASSERT_EQ(mock->published_msgs.size(), 18);
+  for (int i = 0; i < 16; ++i) {
+    auto msg = nlohmann::json::parse(mock->published_msgs[i + 1].second);
+    EXPECT_EQ(msg["frame_id"], i / 2 + 1);
+    EXPECT_EQ(
+        msg["event"], i % 2 == 0 ? "camera_stream_left" : "camera_stream_right");
+  }
+  EXPECT_EQ(nlohmann::json::parse(mock->published_msgs[17].second)["event"], "match_end");
+}
+
+TEST(HookEventPublisherTest, BinaryImageFormat) {
+  std::string pwd = getCurrentDir();
+  cv::Mat imga = cv::imread(pwd + "/../../tests/data/00000.png");
+  cv::Mat imgb = cv::imread(pwd + "/../../tests/data/00001.png");
+
+  for (auto format : {ImageWireFormat::Binary, ImageWireFormat::BinaryStereo}) {
+    auto mock = std::make_shared<MockPublisher>();
+    HookEventPublisherConfig config;
+    config.imageFormat = format;
+    HookEventPublisher event(mock, "test", "test_image", config);
+    event.matchStartCallback();
+    event.cameraStreamCallback(imga, imgb);
+
+    // 二进制模式下逐个分片解析
+    std::vector<frame_message::FramePart> parts;
+    for (size_t i = 1; i < mock->published_msgs.size(); ++i) {
+      const std::string &msg = mock->published_msgs[i].second;
+      EXPECT_EQ(mock->published_msgs[i].first, "test_image");
+      std::vector<frame_message::FramePart> decoded;
+      ASSERT_TRUE(frame_message::decode(
+          reinterpret_cast<const unsigned char *>(msg.data()), msg.size(), decoded));
+      for (auto &part : decoded) {
+        std::vector<unsigned char> buf(part.data, part.data + part.size);
+        cv::Mat img = cv::imdecode(buf, cv::IMREAD_UNCHANGED);
+        EXPECT_EQ(img.rows, static_cast<int>(part.rows));
+        EXPECT_EQ(img.cols, static_cast<int>(part.cols));
+        EXPECT_EQ(img.type(), part.type);
+      }
+      parts.insert(parts.end(), decoded.begin(), decoded.end());
+    }
+
+    EXPECT_EQ(
+        mock->published_msgs.size(), format == ImageWireFormat::Binary ? 3 : 2);
+    ASSERT_EQ(parts.size(), 2);
+    EXPECT_EQ(parts[0].side, CameraSide::Left);
+    EXPECT_EQ(parts[1].side, CameraSide::Right);
+    for (auto &part : parts) {
+      EXPECT_EQ(part.event, EnumEventType::CameraStream);
+      EXPECT_EQ(part.gameId, 1);
+      EXPECT_EQ(part.frameId, 1);
+      EXPECT_EQ(part.codec, ImageCodec::Png);
+      EXPECT_EQ(part.rows, static_cast<uint32_t>(imga.rows));
+      EXPECT_EQ(part.cols, static_cast<uint32_t>(imga.cols));
+    }
+  }
+}
+
+static bool sameImage(const cv::Mat &a, const cv::Mat &b) {
+  if (a.rows != b.rows || a.cols != b.cols || a.type() != b.type()) return false;
+  for (int y = 0; y < a.rows; ++y) {
+    if (std::memcmp(a.ptr(y), b.ptr(y), a.cols * a.elemSize()) != 0) return false;
+  }
+  return true;
+}
+
+TEST(HookEventPublisherTest, FrameDeltaRoundTrip) {
+  auto mock = std::make_shared<MockPublisher>();
+  HookEventPublisherConfig config;
+  config.imageFormat = ImageWireFormat::BinaryStereo;
+  config.encodeThreads = 2;
+  config.delta.keyframeInterval = 4;
+  config.delta.tileSize = 16;
+  HookEventPublisher event(mock, "test", "test_image", config);
+  event.matchStartCallback();
+
+  // 左路有一个移动的方块，右路静止，最后一帧场景切换
+  cv::Mat background(100, 120, CV_8UC3, cv::Scalar(30, 90, 150));
+  std::vector<cv::Mat> frames;
+  for (int i = 0; i < 10; ++i) {
+    cv::Mat frame = background.clone();
+    cv::Mat box = frame(cv::Rect(10 + i * 7, 20, 20, 20));
+    box.setTo(cv::Scalar(255, i * 20, 0));
+    frames.push_back(frame);
+  }
+  frames.push_back(cv::Mat(100, 120, CV_8UC3, cv::Scalar(1, 2, 3)));
+  for (const auto &frame : frames) event.cameraStreamCallback(frame, background);
+  event.flush();
+
+  ASSERT_EQ(mock->published_msgs.size(), frames.size() + 1);
+  FrameDeltaDecoder decoders[2];
+  size_t keyBytes = 0, deltaBytes = 0;
+  for (size_t i = 0; i < frames.size(); ++i) {
+    const std::string &msg = mock->published_msgs[i + 1].second;
+    std::vector<frame_message::FramePart> parts;
+    ASSERT_TRUE(frame_message::decode(
+        reinterpret_cast<const unsigned char *>(msg.data()), msg.size(), parts));
+    ASSERT_EQ(parts.size(), 2);
+
+    for (const auto &part : parts) {
+      // 场景切换只影响左路
+      bool keyframe = i % 4 == 0 || (i == 10 && part.side == CameraSide::Left);
+      EXPECT_EQ(part.codec, keyframe ? ImageCodec::Png : ImageCodec::PngDelta);
+      EXPECT_EQ(part.baseFrameId, keyframe ? 0 : i);
+      (keyframe ? keyBytes : deltaBytes) += part.size;
+      cv::Mat decoded;
+      ASSERT_TRUE(decoders[static_cast<size_t>(part.side)].decode(part, decoded));
+      EXPECT_TRUE(
+          sameImage(decoded, part.side == CameraSide::Left ? frames[i] : background));
+    }
+  }
+  // 7 个增量帧小于 4 个关键帧
+  EXPECT_LT(deltaBytes * 4, keyBytes);
+
+  // 缺少前一帧时无法解码
+  FrameDeltaDecoder late;
+  const std::string &msg = mock->published_msgs[3].second;
+  std::vector<frame_message::FramePart> parts;
+  frame_message::decode(
+      reinterpret_cast<const unsigned char *>(msg.data()), msg.size(), parts);
+  cv::Mat decoded;
+  EXPECT_FALSE(late.decode(parts[0], decoded));
+
+  // JSON 格式的增量帧
+  auto jsonMock = std::make_shared<MockPublisher>();
+  config.imageFormat = ImageWireFormat::Json;
+  HookEventPublisher jsonEvent(jsonMock, "test", "test_image", config);
+  jsonEvent.cameraStreamCallback(frames[0], background);
+  jsonEvent.cameraStreamCallback(frames[1], background);
+  jsonEvent.flush();
+  ASSERT_EQ(jsonMock->published_msgs.size(), 4);
+  auto json = nlohmann::json::parse(jsonMock->published_msgs[2].second);
+  EXPECT_EQ(json.dump(), jsonMock->published_msgs[2].second);
+  EXPECT_EQ(json["codec"], "png_delta");
+  EXPECT_EQ(json["base_frame_id"], 1);
+  EXPECT_EQ(nlohmann::json::parse(jsonMock->published_msgs[0].second).count("codec"), 0);
+
+  // 分块边长须能写入 uint16
+  config.delta.tileSize = 0;
+  EXPECT_THROW(
+      HookEventPublisher(jsonMock, "test", "test_image", config), std::runtime_error);
+  config.delta.tileSize = 65536;
+  EXPECT_THROW(FrameDeltaEncoder(config.delta), std::runtime_error);
+
+  // 分块坐标超出 uint16 时只发送关键帧
+  config.delta.tileSize = 1;
+  FrameDeltaEncoder encoder(config.delta);
+  cv::Mat wide(1, 70000, CV_8UC1, cv::Scalar(0));
+  FrameDelta delta;
+  encoder.next(wide, 1, delta);
+  wide.ptr(0)[69999] = 1;
+  encoder.next(wide, 2, delta);
+  EXPECT_TRUE(delta.keyframe);
+  EXPECT_TRUE(delta.tiles.empty());
+}
+
+TEST(HookEventPublisherTest, ImageCodecs) {
+  cv::Mat frame(90, 120, CV_8UC3, cv::Scalar(10, 20, 30));
+  cv::Mat box = frame(cv::Rect(30, 30, 40, 20));
+  box.setTo(cv::Scalar(200, 100, 50));
+
+  for (auto codec :
+       {ImageCodec::Png,
+        ImageCodec::Jpeg,
+        ImageCodec::Webp,
+        ImageCodec::Raw,
+        ImageCodec::RawLz4,
+        ImageCodec::RawZstd}) {
+    if (!codecSupported(codec)) continue;
+    bool lossless = codec != ImageCodec::Jpeg && codec != ImageCodec::Webp;
+    for (double scale : {1.0, 0.5}) {
+      auto mock = std::make_shared<MockPublisher>();
+      HookEventPublisherConfig config;
+      config.imageFormat = ImageWireFormat::Binary;
+      config.image.codec = codec;
+      config.image.level = 1;
+      config.image.scale = scale;
+      HookEventPublisher event(mock, "test", "test_image", config);
+      event.cameraStreamCallback(frame, frame);
+
+      ASSERT_EQ(mock->published_msgs.size(), 2);
+      const std::string &msg = mock->published_msgs[0].second;
+      std::vector<frame_message::FramePart> parts;
+      ASSERT_TRUE(frame_message::decode(
+          reinterpret_cast<const unsigned char *>(msg.data()), msg.size(), parts));
+      EXPECT_EQ(parts[0].codec, codec);
+      EXPECT_EQ(parts[0].rows, static_cast<uint32_t>(frame.rows * scale));
+      EXPECT_EQ(parts[0].cols, static_cast<uint32_t>(frame.cols * scale));
+      cv::Mat decoded = decodeImage(parts[0]);
+      EXPECT_EQ(decoded.rows, static_cast<int>(parts[0].rows)) << codecName(codec);
+      if (lossless && scale == 1.0) {
+        EXPECT_TRUE(sameImage(decoded, frame)) << codecName(codec);
+      }
+    }
+  }
+
+  // 原始像素分片的尺寸或类型异常时在分配前拒绝
+  std::vector<unsigned char> pixels(16 * 16 * 3);
+  frame_message::FramePart raw;
+  raw.codec = ImageCodec::Raw;
+  raw.rows = 16;
+  raw.cols = 16;
+  raw.type = CV_8UC3;
+  raw.data = pixels.data();
+  raw.size = static_cast<uint32_t>(pixels.size());
+  EXPECT_EQ(decodeImage(raw).rows, 16);
+  frame_message::FramePart bad = raw;
+  bad.rows = 0;
+  EXPECT_TRUE(decodeImage(bad).empty());
+  bad = raw;
+  bad.cols = 0x80000000u;
+  EXPECT_TRUE(decodeImage(bad).empty());
+  bad = raw;
+  bad.rows = 1 << 20;
+  bad.cols = 1 << 20;
+  EXPECT_TRUE(decodeImage(bad).empty());
+  bad = raw;
+  bad.type = 7;  // 不支持的深度
+  EXPECT_TRUE(decodeImage(bad).empty());
+  bad = raw;
+  bad.type = CV_MAKETYPE(CV_8U, 5);
+  EXPECT_TRUE(decodeImage(bad).empty());
+  bad = raw;
+  bad.type = -1;
+  EXPECT_TRUE(decodeImage(bad).empty());
+  bad = raw;
+  bad.size -= 1;
+  EXPECT_TRUE(decodeImage(bad).empty());
+
+  // 原始像素的 JSON 消息带尺寸和类型
+  auto mock = std::make_shared<MockPublisher>();
+  HookEventPublisherConfig config;
+  config.image.codec = ImageCodec::Raw;
+  HookEventPublisher event(mock, "test", "test_image", config);
+  event.cameraStreamCallback(frame, frame);
+  auto json = nlohmann::json::parse(mock->published_msgs[0].second);
+  EXPECT_EQ(json.dump(), mock->published_msgs[0].second);
+  EXPECT_EQ(json["codec"], "raw");
+  EXPECT_EQ(json["rows"], frame.rows);
+  EXPECT_EQ(json["cols"], frame.cols);
+  EXPECT_EQ(json["type"], frame.type());
+
+  config.image.scale = 0;
+  EXPECT_THROW(
+      HookEventPublisher(mock, "test", "test_image", config), std::runtime_error);
+}
+
+TEST(HookEventPublisherTest, BatchedBallPositions) {
+  auto mock = std::make_shared<MockPublisher>();
+  HookEventPublisherConfig config;
+  config.telemetryBatchSize = 3;
+  config.telemetryBatchMs = 20;
+  HookEventPublisher event(mock, "test", "test_image", config);
+
+  // 按条数合并，match_end 前输出剩余数据
+  event.matchStartCallback();
+  for (int i = 0; i < 7; ++i)
+    event.ballPositionCallback(cv::Point2f(i, i), cv::Point2f(i, i));
+  event.matchEndCallback();
+
+  ASSERT_EQ(mock->published_msgs.size(), 5);
+  size_t total = 0;
+  for (size_t i = 1; i < 4; ++i) {
+    auto msg = nlohmann::json::parse(mock->published_msgs[i].second);
+    EXPECT_EQ(msg["event"], "ball_position_batch");
+    EXPECT_EQ(msg["game_id"], 1);
+    total += msg["items"].size();
+  }
+  EXPECT_EQ(total, 7);
+  EXPECT_EQ(nlohmann::json::parse(mock->published_msgs[4].second)["event"], "match_end");
+
+  // 按时间窗口合并
+  event.matchStartCallback();
+  event.ballPositionCallback(cv::Point2f(1, 2), cv::Point2f(3, 4));
+  for (int i = 0; i < 100 && mock->published.load() < 7; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(mock->published_msgs.size(), 7);
+  auto msg = nlohmann::json::parse(mock->published_msgs[6].second);
+  EXPECT_EQ(msg["game_id"], 2);
+  EXPECT_EQ(msg["items"].size(), 1);
+}
+
+TEST(BatchControllerTest, GrowsWithinTargetAndBacksOff) {
+  AdaptiveBatchConfig config;
+  config.enabled = true;
+  config.targetLatencyMs = 20;
+  config.maxItems = 33;
+  config.maxDelayMs = 40;
+  config.maxQueueMessages = 100;
+  BatchController controller(config);
+
+  // 每个周期确认 100 条
+  PublisherStats stats;
+  auto tick = [&](uint64_t latencyUs, std::string *reason) {
+    stats.delivered += 100;
+    stats.totalLatencyUs += 100 * latencyUs;
+    return controller.update(stats, reason);
+  };
+
+  // 确认耗时 2 ms：条数增长到上限，等待时间在估计延迟达到目标一半后停止增长
+  for (int i = 0; i < 20; ++i) tick(2000, nullptr);
+  EXPECT_EQ(controller.limits().items, 33);
+  EXPECT_EQ(controller.limits().delayMs, 9);
+  EXPECT_LE(controller.latencyUs(), 20000);
+  EXPECT_FALSE(tick(2000, nullptr));
+
+  // 延迟超出目标时减半
+  std::string reason;
+  EXPECT_TRUE(tick(30000, &reason));
+  EXPECT_EQ(controller.limits().items, 16);
+  EXPECT_EQ(controller.limits().delayMs, 4);
+  EXPECT_NE(reason.find("latency above target"), std::string::npos);
+
+  // producer 队列积压时减小到下限
+  stats.queueMessages = 1000;
+  EXPECT_TRUE(controller.update(stats, &reason));
+  EXPECT_NE(reason.find("queue backlog"), std::string::npos);
+  for (int i = 0; i < 10; ++i) controller.update(stats);
+  EXPECT_EQ(controller.limits().items, 1);
+  EXPECT_EQ(controller.limits().delayMs, 1);
+  EXPECT_FALSE(controller.update(stats));
+}
+
+TEST(HookEventPublisherTest, AdaptiveTelemetryBatching) {
+  auto mock = std::make_shared<MockPublisher>();
+  HookEventPublisherConfig config;
+  config.adaptiveBatch.enabled = true;
+  config.adaptiveBatch.intervalMs = 5;
+  config.adaptiveBatch.maxItems = 8;
+  config.adaptiveBatch.targetLatencyMs = 20;
+  HookEventPublisher event(mock, "test", "test_image", config);
+
+  // 从逐条推送开始，发布延迟为 0，批次逐步加大
+  event.matchStartCallback();
+  for (int i = 0; i < 100; ++i) {
+    event.ballPositionCallback(cv::Point2f(i, i), cv::Point2f(i, i));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  event.matchEndCallback();
+
+  size_t total = 0;
+  size_t largest = 0;
+  for (const auto &msg : mock->published_msgs) {
+    auto json = nlohmann::json::parse(msg.second);
+    if (json["event"] != "ball_position_batch") continue;
+    total += json["items"].size();
+    largest = std::max(largest, json["items"].size());
+  }
+  EXPECT_EQ(total, 100);
+  EXPECT_GT(largest, 1);
+  EXPECT_LE(largest, 8);
+}
+
+TEST(FrameSamplerTest, ActiveHoldAndIdleRate) {
+  FrameSamplingConfig config;
+  config.activeHoldMs = 500;
+  config.idleFps = 10;
+  FrameSampler sampler(config);
+  typedef FrameSampler::Action Action;
+  auto t0 = FrameSampler::Clock::now();
+  auto at = [&](int ms) { return t0 + std::chrono::milliseconds(ms); };
+
+  // 空闲：第一帧发送，之后每 100ms 发送一帧
+  EXPECT_EQ(sampler.sample(at(0)), Action::Idle);
+  EXPECT_EQ(sampler.sample(at(50)), Action::Hold);
+  EXPECT_EQ(sampler.sample(at(100)), Action::Idle);
+  EXPECT_EQ(sampler.sample(at(150)), Action::Hold);
+
+  // 有活动后保持全帧率至 activeHoldMs
+  sampler.activity(at(160));
+  EXPECT_EQ(sampler.sample(at(170)), Action::Active);
+  EXPECT_EQ(sampler.sample(at(660)), Action::Active);
+  EXPECT_EQ(sampler.sample(at(670)), Action::Idle);
+  EXPECT_EQ(sampler.sample(at(700)), Action::Hold);
+
+  // 按采集时间比较：遥测先于更早采集的帧分发时，这些帧同样视为回合中；
+  // 较早的活动不覆盖较晚的活动
+  sampler.activity(at(2000));
+  sampler.activity(at(1000));
+  EXPECT_EQ(sampler.sample(at(1600)), Action::Active);
+  EXPECT_EQ(sampler.sample(at(2500)), Action::Active);
+  EXPECT_EQ(sampler.sample(at(2600)), Action::Idle);
+
+  config.idleFps = 0;
+  FrameSampler silent(config);
+  EXPECT_EQ(silent.sample(at(0)), Action::Hold);
+  EXPECT_EQ(silent.sample(at(1000)), Action::Hold);
+}
+
+TEST(HookEventPublisherTest, FrameSamplingPreRoll) {
+  auto mock = std::make_shared<MockPublisher>();
+  HookEventPublisherConfig config;
+  config.sampling.enabled = true;
+  config.sampling.idleFps = 0;
+  config.sampling.preRollFrames = 3;
+  HookEventPublisher event(mock, "test", "test_image", config);
+  std::string pwd = getCurrentDir();
+  cv::Mat imga = cv::imread(pwd + "/../../tests/data/00000.png");
+  cv::Mat imgb = cv::imread(pwd + "/../../tests/data/00001.png");
+
+  // 空闲时不发送，只缓存最近 3 帧；球出现后补发缓存帧，再发送当前帧
+  event.matchStartCallback();
+  for (int i = 0; i < 5; ++i) event.cameraStreamCallback(imga, imgb);
+  event.flush();
+  EXPECT_EQ(mock->published_msgs.size(), 1);
+  event.ballPositionCallback(cv::Point2f(1, 1), cv::Point2f(1, 1));
+  event.cameraStreamCallback(imga, imgb);
+  event.matchEndCallback();
+
+  std::vector<int> frameIds;
+  for (const auto &msg : mock->published_msgs) {
+    auto json = nlohmann::json::parse(msg.second);
+    if (json["event"] == "camera_stream_left") frameIds.push_back(json["frame_id"]);
+  }
+  EXPECT_EQ(frameIds, std::vector<int>({3, 4, 5, 6}));
+
+  FrameSamplingStats stats = event.frameSamplingStats();
+  EXPECT_EQ(stats.active, 1);
+  EXPECT_EQ(stats.idle, 0);
+  EXPECT_EQ(stats.preRoll, 3);
+  EXPECT_EQ(stats.dropped, 2);
+}
+
+TEST(HookEventPublisherTest, FrameSamplingUsesCaptureTime) {
+  auto mock = std::make_shared<MockPublisher>();
+  HookEventPublisherConfig config;
+  config.sampling.enabled = true;
+  config.sampling.activeHoldMs = 20;
+  config.sampling.idleFps = 0;
+  config.sampling.preRollFrames = 0;
+  auto event = std::make_shared<HookEventPublisher>(mock, "test", "test_image", config);
+  EventManager manager;
+  manager.addCallback(event);
+  cv::Mat frame(48, 64, CV_8UC3, cv::Scalar(1, 2, 3));
+
+  // 球位置先于排队中的图像分发，但这些图像采集于回合开始之前，不发送
+  manager.emit<MatchStartEvent>();
+  for (int i = 0; i < 3; ++i) manager.emit<CameraStreamEvent>(frame, frame);
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  manager.emit<BallPositionEvent>(cv::Point2f(1, 1), cv::Point2f(1, 1));
+  manager.emit<CameraStreamEvent>(frame, frame);
+  while (manager.poll() != 0) {
+  }
+  event->flush();
+
+  std::vector<int> frameIds;
+  for (const auto &msg : mock->published_msgs) {
+    auto json = nlohmann::json::parse(msg.second);
+    if (json["event"] == "camera_stream_left") frameIds.push_back(json["frame_id"]);
+  }
+  EXPECT_EQ(frameIds, std::vector<int>({4}));
+  EXPECT_EQ(event->frameSamplingStats().dropped, 3);
+}
+
+TEST(EventSerializerTest, RoundTripAllEvents) {
+  std::vector<TelemetryEvent> events(6);
+  EnumEventType types[] = {
+      EnumEventType::MatchStart,
+      EnumEventType::MatchEnd,
+      EnumEventType::BallPosition,
+      EnumEventType::PredTrackBallPosition,
+      EnumEventType::RealTrackBallPosition,
+      EnumEventType::ShuttlecockPosition,
+  };
+  for (size_t i = 0; i < events.size(); ++i) {
+    events[i].type = types[i];
+    events[i].gameId = 7;
+    events[i].frameId = static_cast<uint32_t>(i * 10);
+  }
+  events[2].left = cv::Point2f(0.1f, -2.5f);
+  events[2].right = cv::Point2f(3, 1e-3f);
+  events[3].positions = {{1, 2, 3}, {4.25f, -5, 6}};
+  events[4].positions = {{0.3f, 0, -1}};
+  events[5].position = cv::Point3f(7, 8.5f, 9);
+
+  auto expectEqual = [](const TelemetryEvent &a, const TelemetryEvent &b) {
+    EXPECT_EQ(a.type, b.type);
+    EXPECT_EQ(a.gameId, b.gameId);
+    EXPECT_EQ(a.frameId, b.frameId);
+    EXPECT_EQ(a.left.x, b.left.x);
+    EXPECT_EQ(a.left.y, b.left.y);
+    EXPECT_EQ(a.right.x, b.right.x);
+    EXPECT_EQ(a.right.y, b.right.y);
+    EXPECT_EQ(a.position.x, b.position.x);
+    EXPECT_EQ(a.position.y, b.position.y);
+    EXPECT_EQ(a.position.z, b.position.z);
+    ASSERT_EQ(a.positions.size(), b.positions.size());
+    for (size_t i = 0; i < a.positions.size(); ++i) {
+      EXPECT_EQ(a.positions[i].x, b.positions[i].x);
+      EXPECT_EQ(a.positions[i].y, b.positions[i].y);
+      EXPECT_EQ(a.positions[i].z, b.positions[i].z);
+    }
+  };
+
+  for (auto format : {TelemetryFormat::Json, TelemetryFormat::Binary}) {
+    auto serializer = createEventSerializer(format);
+    std::vector<TelemetryEvent> decoded;
+    for (const auto &event : events) {
+      utils::ByteBuffer buf;
+      serializer->encode(event, buf);
+      ASSERT_TRUE(serializer->decode(buf.data(), buf.size(), decoded));
+      ASSERT_EQ(decoded.size(), 1);
+      expectEqual(decoded[0], event);
+      // JSON 输出与 nlohmann::json::dump 一致
+      if (format == TelemetryFormat::Json) {
+        std::string msg(buf.chars(), buf.size());
+        EXPECT_EQ(nlohmann::json::parse(msg).dump(), msg);
+      }
+    }
+
+    // 批次
+    std::vector<TelemetryEvent> batch(2, events[3]);
+    batch[1].frameId += 1;
+    batch[1].positions.push_back(cv::Point3f(-7, 0.5f, 1));
+    utils::ByteBuffer buf;
+    serializer->encodeBatch(batch.data(), batch.size(), buf);
+    ASSERT_TRUE(serializer->decode(buf.data(), buf.size(), decoded));
+    ASSERT_EQ(decoded.size(), 2);
+    expectEqual(decoded[0], batch[0]);
+    expectEqual(decoded[1], batch[1]);
+
+    // 截断的消息
+    EXPECT_FALSE(serializer->decode(buf.data(), buf.size() - 1, decoded));
+  }
+
+  // JSON 带采集时间（毫秒），二进制不含
+  events[2].timestampUs = 1700000000123456;
+  std::vector<TelemetryEvent> decoded;
+  utils::ByteBuffer json;
+  JsonEventSerializer().encode(events[2], json);
+  ASSERT_TRUE(JsonEventSerializer().decode(json.data(), json.size(), decoded));
+  EXPECT_EQ(decoded[0].timestampUs, 1700000000123000);
+  utils::ByteBuffer binary;
+  BinaryEventSerializer().encode(events[2], binary);
+  ASSERT_TRUE(BinaryEventSerializer().decode(binary.data(), binary.size(), decoded));
+  EXPECT_EQ(decoded[0].timestampUs, 0);
+  events[2].timestampUs = 0;
+
+  // 二进制 ball_position 为 8 + 12 + 16 字节
+  utils::ByteBuffer buf;
+  BinaryEventSerializer().encode(events[2], buf);
+  EXPECT_EQ(buf.size(), 36);
+
+  // 缺少字段或类型不符时返回 false，不抛出异常
+  const char *malformed[] = {
+      R"([1,2])",
+      R"({"game_id":1})",
+      R"({"event":"ball_position","game_id":1})",
+      R"({"event":"ball_position","frame_id":1,"game_id":1})",
+      R"({"event":"ball_position","frame_id":1,"game_id":1,)"
+      R"("left":[1,"x"],"right":[1,2]})",
+      R"({"event":"shuttlecock_position","frame_id":"1","game_id":1,)"
+      R"("position":[1,2,3]})",
+      R"({"event":"shuttlecock_position","frame_id":1,"game_id":1,)"
+      R"("position":[1,2]})",
+      R"({"event":"real_track_ball_position","frame_id":1,"game_id":1,)"
+      R"("positions":[[1,2]]})",
+      R"({"event":"ball_position","frame_id":1,"game_id":1,"timestamp":"x"})",
+      R"({"event":"ball_position_batch","game_id":1})",
+      R"({"event":"ball_position_batch","game_id":1,"items":[{"frame_id":1}]})",
+  };
+  JsonEventSerializer serializer;
+  for (const char *msg : malformed) {
+    EXPECT_FALSE(serializer.decode(
+        reinterpret_cast<const unsigned char *>(msg), std::strlen(msg), decoded))
+        << msg;
+  }
+
+  // 非有限值编码为 null，解码为 NaN
+  events[5].position.x = std::numeric_limits<float>::quiet_NaN();
+  json.clear();
+  serializer.encode(events[5], json);
+  EXPECT_NE(std::string(json.chars(), json.size()).find("[null,8.5,9.0]"),
+            std::string::npos);
+  ASSERT_TRUE(serializer.decode(json.data(), json.size(), decoded));
+  EXPECT_TRUE(std::isnan(decoded[0].position.x));
+  EXPECT_EQ(decoded[0].position.y, 8.5f);
+}
+
+TEST(HookEventPublisherTest, PipelineMetrics) {
+  auto metrics = std::make_shared<PipelineMetrics>();
+  auto mock = std::make_shared<MockPublisher>();
+  HookEventPublisherConfig publisherConfig;
+  publisherConfig.metrics = metrics;
+  auto event =
+      std::make_shared<HookEventPublisher>(mock, "test", "test_image", publisherConfig);
+
+  EventManagerConfig managerConfig;
+  managerConfig.metrics = metrics;
+  EventManager manager(managerConfig);
+  manager.addCallback(event);
+  manager.start();
+
+  cv::Mat frame(48, 64, CV_8UC3, cv::Scalar(1, 2, 3));
+  manager.emit<MatchStartEvent>();
+  manager.emit<CameraStreamEvent>(frame, frame);
+  manager.emit<BallPositionEvent>(cv::Point2f(1, 2), cv::Point2f(3, 4));
+  manager.emit<MatchEndEvent>();
+  for (int i = 0; i < 100 && mock->published.load() < 5; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  manager.stop();
+
+  EXPECT_EQ(metrics->histogram(PipelineStage::Queue, EnumEventType::CameraStream).count(), 1);
+  EXPECT_EQ(metrics->histogram(PipelineStage::Encode, EnumEventType::CameraStream).count(), 2);
+  EXPECT_EQ(
+      metrics->histogram(PipelineStage::Serialize, EnumEventType::CameraStream).count(), 2);
+  EXPECT_EQ(
+      metrics->histogram(PipelineStage::Publish, EnumEventType::BallPosition).count(), 1);
+  EXPECT_EQ(metrics->histogram(PipelineStage::Queue, EnumEventType::MatchEnd).count(), 1);
+
+  HookEventMetrics snapshot;
+  snapshot.queue = manager.queueStats();
+  auto lanes = nlohmann::json::parse(snapshot.toJson())["queue"]["lanes"];
+  EXPECT_EQ(lanes["control"]["dispatched"], 2);
+  EXPECT_EQ(lanes["media"]["dispatched"], 1);
+  EXPECT_EQ(lanes["telemetry"]["wait_us"]["count"], 1);
+}
+
+// 记录发布选项
+class OptionsMockPublisher : public MockPublisher {
+ public:
+  using BasePublisher::publish;
+  std::vector<PublishOptions> options;
+  bool publish(
+      const std::string &topic,
+      utils::PooledBuffer message,
+      const PublishOptions &opts) override {
+    options.push_back(opts);
+    return MockPublisher::publish(topic, message->data(), message->size());
+  }
+};
+
+TEST(HookEventPublisherTest, CaptureTimestampsAndLatencyProbe) {
+  auto mock = std::make_shared<OptionsMockPublisher>();
+  EventManager manager;
+  manager.addCallback(std::make_shared<HookEventPublisher>(mock));
+
+  // 未启动时事件留在队列中，排队时间计入采集到发布的延迟
+  int64_t before = event_clock::wallUs();
+  cv::Mat frame(48, 64, CV_8UC3, cv::Scalar(1, 2, 3));
+  manager.emit<MatchStartEvent>();
+  manager.emit<CameraStreamEvent>(frame, frame);
+  manager.emit<BallPositionEvent>(cv::Point2f(1, 2), cv::Point2f(3, 4));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  while (manager.poll()) {
+  }
+  int64_t after = event_clock::wallUs();
+
+  ASSERT_EQ(mock->options.size(), 4);
+  LatencyProbe probe;
+  std::set<std::string> events;
+  for (size_t i = 0; i < mock->options.size(); ++i) {
+    const PublishOptions &options = mock->options[i];
+    ASSERT_EQ(options.headers.size(), 3);
+    EXPECT_EQ(options.headers[0].first, event_clock::kHeaderEvent);
+    events.insert(options.headers[0].second);
+    int64_t captured = std::stoll(options.headers[1].second);
+    int64_t published = std::stoll(options.headers[2].second);
+    EXPECT_GE(captured, before - 1000);
+    EXPECT_GE(published - captured, 20000);
+    EXPECT_LE(published, after);
+    EXPECT_EQ(options.timestampMs, captured / 1000);
+    // JSON 消息带采集时间（毫秒）
+    auto json = nlohmann::json::parse(mock->published_msgs[i].second);
+    EXPECT_EQ(json["timestamp"], captured / 1000);
+    EXPECT_EQ(json.dump(), mock->published_msgs[i].second);
+    EXPECT_TRUE(probe.record(options.headers, after));
+  }
+  std::set<std::string> expected = {
+      "match_start", "ball_position", "camera_stream_left", "camera_stream_right"};
+  EXPECT_EQ(events, expected);
+
+  // 每个事件类型一行
+  std::vector<LatencyStats> stats = probe.stats();
+  ASSERT_EQ(stats.size(), 4);
+  for (const auto &s : stats) {
+    EXPECT_EQ(s.endToEndUs.count, 1);
+    EXPECT_GE(s.endToEndUs.max, 19000);
+    EXPECT_EQ(s.pipelineUs.count, 1);
+    EXPECT_EQ(s.skewed, 0);
+  }
+  EXPECT_NE(probe.report().find("camera_stream_left"), std::string::npos);
+
+  // 缺少采集时间时不统计，时钟偏差按 0 计入
+  EXPECT_FALSE(probe.record(LatencyProbe::Headers{{"hk-event", "x"}}, after));
+  probe.reset();
+  probe.record("ball_position", 2000, 0, 1000);
+  stats = probe.stats();
+  ASSERT_EQ(stats.size(), 1);
+  EXPECT_EQ(stats[0].skewed, 1);
+  EXPECT_EQ(stats[0].endToEndUs.max, 0);
+  EXPECT_EQ(stats[0].pipelineUs.count, 0);
 }
 
 TEST(HookEventPublisherTest, KafkaEventFullTest) {
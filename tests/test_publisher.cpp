@@ -1,6 +1,15 @@
+#include <dirent.h>
 #include <gtest/gtest.h>
+#include <stdlib.h>
+#include <unistd.h>
 
+#include <atomic>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
 
 #include "hook_event/publisher/factory_publisher.hpp"
 
@@ -24,6 +33,25 @@ TEST(PublisherFactoryTest, CreateKafkaPublisher) {
   // 可以继续测试 publish/create_topic 等接口的行为（可用 mock 或 stub）
 }
 
+TEST(PublisherFactoryTest, CreateNullPublisher) {
+  auto publisher = PublisherFactory::createNullPublisher();
+  ASSERT_NE(dynamic_cast<NullPublisher *>(publisher.get()), nullptr);
+
+  bool ok = false;
+  EXPECT_TRUE(publisher->publishAsync(
+      "test_topic",
+      reinterpret_cast<const unsigned char *>("hello"),
+      5,
+      [&](const PublishResult &result) { ok = result.ok; }));
+  EXPECT_TRUE(publisher->publish("test_topic", "world"));
+  EXPECT_TRUE(ok);
+  EXPECT_TRUE(publisher->flush(0));
+  EXPECT_EQ(publisher->stats().delivered, 2);
+  auto null = std::static_pointer_cast<NullPublisher>(publisher);
+  EXPECT_EQ(null->messages(), 2);
+  EXPECT_EQ(null->bytes(), 10);
+}
+
 TEST(PublisherFactoryTest, KafkaPublisherPublish) {
   KafkaPublisherConfig config;
   config.bootstrapServers = "localhost:9092";
@@ -42,3 +70,374 @@ TEST(PublisherFactoryTest, KafkaPublisherPublish) {
   // 因为producer_未初始化，publish应返回false
   EXPECT_TRUE(published);
 }
+
+TEST(PublisherFactoryTest, KafkaPublisherPublishPooledBuffer) {
+  KafkaPublisherConfig config;
+  config.bootstrapServers = "localhost:9092";
+  auto publisher = PublisherFactory::createKafkaPublisher(config);
+
+  // 缓冲区所有权转移给 librdkafka，投递完成后归还池
+  hook_event::utils::BufferPool pool(4);
+  auto buffer = pool.acquire();
+  buffer->append("hello pooled");
+  EXPECT_TRUE(publisher->publish("test_topic", std::move(buffer)));
+
+  publisher.reset();
+  EXPECT_EQ(pool.idle(), 1);
+}
+
+TEST(PublisherFactoryTest, KafkaPublisherPublishAsync) {
+  KafkaPublisherConfig config;
+  config.bootstrapServers = "localhost:9092";
+  auto publisher = PublisherFactory::createKafkaPublisher(config);
+
+  std::atomic<int> delivered{0};
+  std::string topic;
+  bool queued = publisher->publishAsync(
+      "test_topic",
+      reinterpret_cast<const unsigned char *>("hello async"),
+      11,
+      [&](const PublishResult &result) {
+        if (result.ok) topic = result.topic;
+        ++delivered;
+      });
+  EXPECT_TRUE(queued);
+
+  // flush 返回后所有回调均已执行
+  EXPECT_TRUE(publisher->flush(5000));
+  EXPECT_EQ(delivered.load(), 1);
+  EXPECT_EQ(topic, "test_topic");
+
+  PublisherStats stats = publisher->stats();
+  EXPECT_EQ(stats.inFlightMessages, 0);
+  EXPECT_EQ(stats.inFlightBytes, 0);
+  EXPECT_EQ(stats.delivered, 1);
+  EXPECT_EQ(stats.failed, 0);
+}
+
+TEST(PublisherFactoryTest, KafkaPublisherTopicConfig) {
+  KafkaPublisherConfig config;
+  config.bootstrapServers = "localhost:9092";
+  config.topicConfigs["test_image"] = {{"compression.type", "lz4"}};
+  auto publisher = PublisherFactory::createKafkaPublisher(config);
+
+  // 带 key 发布，主题句柄复用
+  PublishOptions options;
+  options.key = "1:left";
+  for (int i = 0; i < 3; ++i)
+    EXPECT_TRUE(publisher->publish("test_image", "frame", options));
+  // 带时间戳和消息头时同样复用主题句柄
+  options.timestampMs = 1700000000000;
+  options.headers = {{"hk-event", "camera_stream_left"}, {"hk-capture-us", "1"}};
+  EXPECT_TRUE(publisher->publish("test_image", "frame", options));
+  EXPECT_TRUE(publisher->flush(5000));
+  EXPECT_EQ(publisher->stats().delivered, 4);
+
+  // 主题配置错误在构造时抛出
+  config.topicConfigs["test_image"] = {{"invalid.key", "1"}};
+  EXPECT_THROW(PublisherFactory::createKafkaPublisher(config), std::runtime_error);
+}
+
+TEST(PublisherFactoryTest, KafkaPublisherStatistics) {
+  KafkaPublisherConfig config;
+  config.bootstrapServers = "localhost:9092";
+  config.statisticsIntervalMs = "100";
+  auto publisher = PublisherFactory::createKafkaPublisher(config);
+
+  EXPECT_TRUE(publisher->publish("test_topic", "hello stats"));
+  EXPECT_TRUE(publisher->flush(5000));
+  for (int i = 0; i < 50 && publisher->stats().statsUpdates == 0; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  // 统计字段来自 librdkafka 上报的 JSON
+  PublisherStats stats = publisher->stats();
+  EXPECT_GT(stats.statsUpdates, 0);
+  EXPECT_GT(stats.rttAvgUs, 0);
+  EXPECT_GE(stats.rttP99Us, stats.rttAvgUs);
+  EXPECT_GT(stats.batchSizeAvg, 0);
+  EXPECT_EQ(stats.deliveryLatencyUs.count, 1);
+}
+
+// 可切换可用状态的内层发布器
+class FlakyPublisher : public BasePublisher {
+ public:
+  std::atomic<bool> available{false};
+  std::mutex mutex;
+  std::vector<std::pair<std::string, std::string>> messages;  // key, payload
+  PublishOptions lastOptions;
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size) override {
+    return publish(topic, message, size, PublishOptions());
+  }
+
+  bool publish(
+      const std::string &topic,
+      const unsigned char *message,
+      const size_t size,
+      const PublishOptions &options) override {
+    bool ok = available.load();
+    if (ok) {
+      std::lock_guard<std::mutex> lock(mutex);
+      messages.emplace_back(
+          options.key, std::string(reinterpret_cast<const char *>(message), size));
+      lastOptions = options;
+    }
+    auto start = std::chrono::steady_clock::now();
+    complete(topic, ok, start, options);
+    return ok;
+  }
+
+  bool create_topic(
+      const std::string &topic,
+      const std::map<std::string, std::string> &options = {}) override {
+    return true;
+  }
+};
+
+static std::string makeSpillDir() {
+  char path[] = "/tmp/hook_event_spill_XXXXXX";
+  return mkdtemp(path);
+}
+
+static size_t countSpillFiles(const std::string &directory) {
+  size_t count = 0;
+  DIR *dir = opendir(directory.c_str());
+  while (struct dirent *entry = readdir(dir)) {
+    if (std::string(entry->d_name).find(".spill") != std::string::npos) ++count;
+  }
+  closedir(dir);
+  return count;
+}
+
+static void removeSpillDir(const std::string &directory) {
+  DIR *dir = opendir(directory.c_str());
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name != "." && name != "..") unlink((directory + "/" + name).c_str());
+  }
+  closedir(dir);
+  rmdir(directory.c_str());
+}
+
+TEST(SpillPublisherTest, ReplaysInOrderAfterRecovery) {
+  auto inner = std::make_shared<FlakyPublisher>();
+  SpillPublisherConfig config;
+  config.directory = makeSpillDir();
+  config.segmentBytes = 64 << 10;
+  config.retryIntervalMs = 10;
+  auto publisher = PublisherFactory::createSpillPublisher(inner, config);
+
+  std::atomic<int> delivered{0};
+  std::string payload(1000, 'x');
+  for (int i = 0; i < 200; ++i) {
+    PublishOptions options;
+    options.key = std::to_string(i);
+    if (i % 2) options.callback = [&](const PublishResult &r) { delivered += r.ok; };
+    EXPECT_TRUE(publisher->publish("test_topic", payload + options.key, options));
+  }
+  PublisherStats stats = publisher->stats();
+  EXPECT_EQ(stats.spilledMessages, 200);
+  EXPECT_EQ(stats.spillPendingMessages, 200);
+  EXPECT_GT(countSpillFiles(config.directory), 1);
+  EXPECT_EQ(delivered.load(), 0);
+
+  // 恢复后按写入顺序回放，之后的消息排在落盘消息之后
+  inner->available = true;
+  EXPECT_TRUE(publisher->publish("test_topic", "after"));
+  EXPECT_TRUE(publisher->flush(5000));
+  ASSERT_EQ(inner->messages.size(), 201);
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_EQ(inner->messages[i].first, std::to_string(i));
+    EXPECT_EQ(inner->messages[i].second, payload + std::to_string(i));
+  }
+  EXPECT_EQ(inner->messages[200].second, "after");
+  EXPECT_EQ(delivered.load(), 100);
+  stats = publisher->stats();
+  // 回放期间发布的消息同样落盘
+  EXPECT_EQ(stats.replayedMessages, 201);
+  EXPECT_EQ(stats.spillPendingBytes, 0);
+  EXPECT_EQ(countSpillFiles(config.directory), 0);
+
+  // 恢复后直接发布
+  EXPECT_TRUE(publisher->publish("test_topic", "direct"));
+  EXPECT_EQ(inner->messages.size(), 202);
+
+  // 带回调时时间戳和消息头同样传给内层发布器
+  PublishOptions options;
+  options.key = "stamped";
+  options.timestampMs = 1234;
+  options.headers.emplace_back("hk-event", "ball_position");
+  options.callback = [&](const PublishResult &r) { delivered += r.ok; };
+  EXPECT_TRUE(publisher->publish("test_topic", "stamped", options));
+  EXPECT_EQ(inner->lastOptions.key, "stamped");
+  EXPECT_EQ(inner->lastOptions.timestampMs, 1234);
+  ASSERT_EQ(inner->lastOptions.headers.size(), 1);
+  EXPECT_EQ(inner->lastOptions.headers[0].second, "ball_position");
+  EXPECT_EQ(delivered.load(), 101);
+
+  // 落盘后回放的消息保留时间戳和消息头
+  inner->available = false;
+  options.key = "spilled";
+  options.timestampMs = 5678;
+  options.headers.emplace_back("hk-capture-us", "");
+  EXPECT_TRUE(publisher->publish("test_topic", "spilled", options));
+  EXPECT_EQ(publisher->stats().spilledMessages, 202);
+  inner->available = true;
+  EXPECT_TRUE(publisher->flush(5000));
+  ASSERT_EQ(inner->messages.size(), 204);
+  EXPECT_EQ(inner->messages.back().second, "spilled");
+  EXPECT_EQ(inner->lastOptions.key, "spilled");
+  EXPECT_EQ(inner->lastOptions.timestampMs, 5678);
+  ASSERT_EQ(inner->lastOptions.headers.size(), 2);
+  EXPECT_EQ(inner->lastOptions.headers[0].first, "hk-event");
+  EXPECT_EQ(inner->lastOptions.headers[0].second, "ball_position");
+  EXPECT_EQ(inner->lastOptions.headers[1].first, "hk-capture-us");
+  EXPECT_EQ(inner->lastOptions.headers[1].second, "");
+  EXPECT_EQ(delivered.load(), 102);
+  publisher.reset();
+  removeSpillDir(config.directory);
+}
+
+TEST(SpillPublisherTest, RecoversSegmentsAfterRestart) {
+  auto inner = std::make_shared<FlakyPublisher>();
+  SpillPublisherConfig config;
+  config.directory = makeSpillDir();
+  config.retryIntervalMs = 10;
+  {
+    auto publisher = PublisherFactory::createSpillPublisher(inner, config);
+    for (int i = 0; i < 10; ++i)
+      EXPECT_TRUE(publisher->publish("test_topic", "msg" + std::to_string(i)));
+  }
+  EXPECT_EQ(countSpillFiles(config.directory), 1);
+
+  inner->available = true;
+  auto publisher = PublisherFactory::createSpillPublisher(inner, config);
+  EXPECT_TRUE(publisher->flush(5000));
+  ASSERT_EQ(inner->messages.size(), 10);
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(inner->messages[i].second, "msg" + std::to_string(i));
+  publisher.reset();
+  removeSpillDir(config.directory);
+}
+
+TEST(SpillPublisherTest, ReplaysVersion1Segments) {
+  auto inner = std::make_shared<FlakyPublisher>();
+  inner->available = true;
+  SpillPublisherConfig config;
+  config.directory = makeSpillDir();
+
+  // 版本 1 的段：记录体头 8 字节，没有时间戳和消息头
+  std::vector<unsigned char> file(4096, 0);
+  const unsigned char header[] = {'H', 'K', 'S', 'P', 1, 0, 0, 0};
+  std::memcpy(file.data(), header, sizeof(header));
+  file[16] = 32;  // 已回放位置
+  const unsigned char body[] = {1, 0, 1, 0, 0, 0, 0, 0, 't', 'k', 'v', '1'};
+  uint32_t crc = hook_event::utils::crc32(body, sizeof(body));
+  file[32] = sizeof(body);
+  for (int i = 0; i < 4; ++i) file[36 + i] = static_cast<unsigned char>(crc >> (8 * i));
+  std::memcpy(file.data() + 40, body, sizeof(body));
+  std::string path = config.directory + "/00000000000000000000.spill";
+  FILE *out = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(out, nullptr);
+  std::fwrite(file.data(), 1, file.size(), out);
+  std::fclose(out);
+
+  auto publisher = PublisherFactory::createSpillPublisher(inner, config);
+  EXPECT_TRUE(publisher->flush(5000));
+  ASSERT_EQ(inner->messages.size(), 1);
+  EXPECT_EQ(inner->messages[0].first, "k");
+  EXPECT_EQ(inner->messages[0].second, "v1");
+  EXPECT_EQ(inner->lastOptions.timestampMs, 0);
+  EXPECT_TRUE(inner->lastOptions.headers.empty());
+  publisher.reset();
+  removeSpillDir(config.directory);
+}
+
+TEST(SpillPublisherTest, BoundedDiskUsage) {
+  auto inner = std::make_shared<FlakyPublisher>();
+  SpillPublisherConfig config;
+  config.directory = makeSpillDir();
+  config.segmentBytes = 16 << 10;
+  config.maxSegments = 2;
+  auto publisher = PublisherFactory::createSpillPublisher(inner, config);
+
+  std::string payload(1000, 'x');
+  int accepted = 0;
+  for (int i = 0; i < 100; ++i) accepted += publisher->publish("test_topic", payload);
+  // 过大的消息直接丢弃
+  EXPECT_FALSE(publisher->publish("test_topic", std::string(32 << 10, 'y')));
+
+  PublisherStats stats = publisher->stats();
+  EXPECT_LT(accepted, 100);
+  EXPECT_EQ(stats.spilledMessages, static_cast<uint64_t>(accepted));
+  EXPECT_EQ(stats.spillDropped, static_cast<uint64_t>(101 - accepted));
+  EXPECT_LE(countSpillFiles(config.directory), 2);
+  publisher.reset();
+  removeSpillDir(config.directory);
+}
+
+TEST(ShardedPublisherTest, RoutesByTopicAndKey) {
+  std::vector<std::shared_ptr<FlakyPublisher>> inner;
+  std::vector<std::shared_ptr<BasePublisher>> shards;
+  for (int i = 0; i < 4; ++i) {
+    inner.push_back(std::make_shared<FlakyPublisher>());
+    inner.back()->available = true;
+    shards.push_back(inner.back());
+  }
+  ShardedPublisherConfig config;
+  config.dedicatedTopics = {"telemetry"};
+  ShardedPublisher publisher(shards, config);
+
+  // 独占主题只进入分片 0，其他主题不会进入分片 0
+  for (int i = 0; i < 10; ++i) {
+    PublishOptions options;
+    options.key = "12:" + std::to_string(i % 2);
+    EXPECT_TRUE(publisher.publish("telemetry", "t" + std::to_string(i), options));
+    EXPECT_TRUE(publisher.publish("image", "i" + std::to_string(i), options));
+  }
+  EXPECT_EQ(inner[0]->messages.size(), 10);
+  for (const auto &message : inner[0]->messages) EXPECT_EQ(message.second[0], 't');
+
+  // 同一 key 的消息在同一分片内保持顺序
+  for (int key = 0; key < 2; ++key) {
+    size_t shard = publisher.shardOf("image", "12:" + std::to_string(key));
+    EXPECT_GE(shard, 1);
+    std::vector<std::string> received;
+    for (const auto &message : inner[shard]->messages) {
+      if (message.first == "12:" + std::to_string(key))
+        received.push_back(message.second);
+    }
+    ASSERT_EQ(received.size(), 5);
+    for (int i = 0; i < 5; ++i)
+      EXPECT_EQ(received[i], "i" + std::to_string(i * 2 + key));
+  }
+
+  // 不同 key 分散到多个分片
+  std::set<size_t> used;
+  for (int i = 0; i < 64; ++i)
+    used.insert(publisher.shardOf("image", "key" + std::to_string(i)));
+  EXPECT_EQ(used.size(), 3);
+
+  EXPECT_TRUE(publisher.flush(1000));
+
+  // 至少保留一个共享分片
+  config.dedicatedTopics = {"a", "b", "c", "d"};
+  EXPECT_THROW(ShardedPublisher(shards, config), std::runtime_error);
+}
+
+TEST(PublisherFactoryTest, CreateShardedKafkaPublisher) {
+  KafkaPublisherConfig config;
+  ShardedPublisherConfig sharded;
+  sharded.shards = 3;
+  sharded.dedicatedTopics = {"test"};
+  auto publisher = PublisherFactory::createShardedKafkaPublisher(config, sharded);
+  auto shardedPtr = dynamic_cast<ShardedPublisher *>(publisher.get());
+  ASSERT_NE(shardedPtr, nullptr);
+  EXPECT_EQ(shardedPtr->shardCount(), 3);
+  EXPECT_TRUE(publisher->publish("test", "hello"));
+  EXPECT_TRUE(publisher->publish("test_image", "world"));
+  EXPECT_TRUE(publisher->flush(1000));
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hook_event/utils/base64.hpp"
+#include "hook_event/utils/buffer_pool.hpp"
+#include "hook_event/utils/histogram.hpp"
+#include "hook_event/utils/object_pool.hpp"
+
+using namespace hook_event::utils;
+
+TEST(Base64Test, KnownVectors) {
+  const std::pair<std::string, std::string> cases[] = {
+      {"", ""},
+      {"f", "Zg=="},
+      {"fo", "Zm8="},
+      {"foo", "Zm9v"},
+      {"foob", "Zm9vYg=="},
+      {"fooba", "Zm9vYmE="},
+      {"foobar", "Zm9vYmFy"},
+  };
+  for (const auto &c : cases) {
+    std::vector<unsigned char> in(c.first.begin(), c.first.end());
+    EXPECT_EQ(encode_base64(in), c.second);
+
+    std::vector<unsigned char> out;
+    ASSERT_TRUE(decode_base64(c.second, out));
+    EXPECT_EQ(out, in);
+  }
+}
+
+TEST(Base64Test, AllImplsRoundTrip) {
+  std::mt19937 rng(42);
+  for (size_t size : {1, 2, 3, 11, 12, 15, 16, 27, 28, 29, 100, 1000, 65537}) {
+    std::vector<unsigned char> in(size);
+    for (auto &b : in) b = static_cast<unsigned char>(rng());
+
+    std::string expected(base64_encoded_size(size), '\0');
+    encode_base64(in.data(), size, &expected[0], Base64Impl::Scalar);
+
+    for (auto impl : {Base64Impl::Ssse3, Base64Impl::Avx2}) {
+      if (!base64_impl_supported(impl)) continue;
+      std::string out(base64_encoded_size(size), '\0');
+      EXPECT_EQ(encode_base64(in.data(), size, &out[0], impl), out.size());
+      EXPECT_EQ(out, expected) << "size " << size;
+    }
+
+    std::vector<unsigned char> decoded;
+    ASSERT_TRUE(decode_base64(expected, decoded));
+    EXPECT_EQ(decoded, in);
+  }
+}
+
+TEST(Base64Test, DecodeRejectsInvalid) {
+  std::vector<unsigned char> out;
+  EXPECT_FALSE(decode_base64(std::string("Zm9"), out));
+  EXPECT_FALSE(decode_base64(std::string("Zm$v"), out));
+  EXPECT_FALSE(decode_base64(std::string("Z=9v"), out));
+  EXPECT_FALSE(decode_base64(std::string("Zm=v"), out));
+}
+
+TEST(BufferPoolTest, ReusesReleasedBuffers) {
+  BufferPool pool(1);
+  const unsigned char *first = nullptr;
+  {
+    PooledBuffer buf = pool.acquire(1024);
+    buf->append("hello");
+    EXPECT_EQ(buf->size(), 5);
+    EXPECT_GE(buf->capacity(), 1024);
+    first = buf->data();
+  }
+  EXPECT_EQ(pool.idle(), 1);
+
+  // 归还后容量保留，内容清空
+  PooledBuffer buf = pool.acquire(16);
+  EXPECT_EQ(buf->data(), first);
+  EXPECT_TRUE(buf->empty());
+  PooledBuffer other = pool.acquire();
+  EXPECT_NE(other->data(), first);
+
+  buf.reset();
+  other.reset();
+  EXPECT_EQ(pool.idle(), 1);
+}
+
+TEST(ObjectPoolTest, RefCountedReuse) {
+  hook_event::utils::ObjectPool<std::vector<int>> pool(2);
+  {
+    auto a = pool.acquire();
+    a->assign(16, 1);
+    auto b = a;  // 共享同一对象
+    EXPECT_EQ(b->size(), 16);
+    a.reset();
+    EXPECT_EQ(pool.idle(), 0);
+  }
+  EXPECT_EQ(pool.idle(), 1);
+
+  // 归还的对象保留容量
+  auto c = pool.acquire();
+  EXPECT_GE(c->capacity(), 16);
+  EXPECT_EQ(pool.idle(), 0);
+}
+
+TEST(HistogramTest, Percentiles) {
+  hook_event::utils::Histogram hist;
+  for (uint64_t v = 1; v <= 10000; ++v) hist.record(v);
+  auto snap = hist.snapshot();
+  EXPECT_EQ(snap.count, 10000);
+  EXPECT_EQ(snap.min, 1);
+  EXPECT_EQ(snap.max, 10000);
+  EXPECT_DOUBLE_EQ(snap.mean(), 5000.5);
+  // 相对误差不超过 1/16
+  EXPECT_NEAR(snap.p50, 5000, 5000 / 16);
+  EXPECT_NEAR(snap.p99, 9900, 9900 / 16);
+  EXPECT_LE(snap.p999, snap.max);
+
+  // 每个值落在所属桶的范围内
+  for (uint64_t v : {0ull, 31ull, 32ull, 33ull, 1000ull, 123456789ull}) {
+    size_t bucket = hook_event::utils::Histogram::bucketOf(v);
+    EXPECT_GE(hook_event::utils::Histogram::bucketHigh(bucket), v);
+    if (bucket) {
+      EXPECT_LT(hook_event::utils::Histogram::bucketHigh(bucket - 1), v);
+    }
+  }
+}